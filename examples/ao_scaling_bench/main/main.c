@@ -0,0 +1,317 @@
+/**
+ * @file main.c
+ * @brief AO scaling benchmark: thread-per-AO vs. cooperative scheduler
+ *
+ * @details
+ * Instantiates growing numbers of identical AOs (1 ... 1000), first each
+ * with its own FreeRTOS task (Active_start) and then all attached to one
+ * ActiveSched (Active_attach). For every count it reports:
+ *
+ * - RAM per AO: heap consumed while creating the AOs (each AO with its
+ *   queue and, in thread mode, its stack in one heap block), including
+ *   allocator overhead and anything the kernel allocates on the way
+ * - post latency: time spent inside Active_post()
+ * - dispatch latency: time from Active_post() to the start of the handler
+ * - timer load: CPU time consumed while every AO runs a periodic
+ *   TimeEvent, with the aggregate rate fixed at AGG_RATE_HZ
+ *
+ * A count is skipped (and the mode ends) once its storage no longer fits
+ * in the heap. The cooperative AOs run with SCHED_FIXED_PRIO and no
+ * deadline, so the scheduler's deadline-miss count means nothing here and
+ * is not reported.
+ */
+
+#include <string.h>
+
+#include "FreeAct.h"
+#include "FreeAct_cycles.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "freertos/semphr.h"
+
+#if CONFIG_FREEACT_REGISTRY
+#error "the AO registry only grows; this benchmark recycles AO storage between runs"
+#endif
+
+/** @brief Log tag for this module */
+#define TAG "scale_bench"
+
+/** @brief Event queue depth of every AO */
+#define NODE_QUEUE_LEN 4U
+
+/** @brief Stack size of one AO thread (thread-per-AO mode) */
+#define NODE_STACK_SIZE 1536U
+
+/** @brief Stack size of the cooperative scheduler thread */
+#define SCHED_STACK_SIZE 4096U
+
+/** @brief Aggregate TimeEvent rate, independent of the number of AOs */
+#define AGG_RATE_HZ 1000U
+
+/** @brief Duration of one timer-load measurement */
+#define LOAD_WINDOW_MS 1000U
+
+/** @brief Number of post/dispatch latency samples per count */
+#define N_PROBES 200U
+
+/** @brief Heap left untouched for the rest of the system */
+#define HEAP_RESERVE 16384U
+
+/** @brief Largest AO count */
+#define MAX_AOS 1000U
+
+/** @brief Priorities: load spinner < AOs < benchmark task */
+#define SPIN_PRIO  1U
+#define NODE_PRIO  2U
+#define BENCH_PRIO 5U
+
+enum Signals
+{
+    TICK_SIG = USER_SIG,  ///< Periodic TimeEvent
+    PROBE_SIG,            ///< Latency probe
+};
+
+/** @brief Latency probe carrying its post timestamp */
+typedef struct
+{
+    Event    super;  ///< Inherit Event
+    uint32_t stamp;  ///< FreeAct_cycles() at post
+} ProbeEvt;
+
+/** @brief The AO under test: counts ticks, answers probes */
+typedef struct
+{
+    Active    super;   ///< Inherit Active base class
+    TimeEvent tick;    ///< Periodic load
+    uint32_t  nTicks;  ///< Ticks dispatched
+} Node;
+
+typedef enum
+{
+    MODE_THREAD,  ///< One FreeRTOS task per AO
+    MODE_COOP,    ///< All AOs on one ActiveSched
+} Mode;
+
+static uint16_t const l_counts[] = {1U, 10U, 50U, 100U, 250U, 500U, MAX_AOS};
+
+#define N_COUNTS (sizeof(l_counts) / sizeof(l_counts[0]))
+
+static Node*             l_nodes[MAX_AOS]; // one heap block per AO, queue (and stack) behind it
+static ProbeEvt          l_probe = {{PROBE_SIG}, 0U};
+static uint32_t          l_dispNs;      // sum of probe dispatch latencies
+static SemaphoreHandle_t l_probeDone;
+static uint32_t volatile l_spins;       // load spinner progress
+static uint32_t          l_idleSpins;   // spinner progress without AOs
+
+static void Node_dispatch(Node* const me, Event const* const e)
+{
+    switch (e->sig)
+    {
+        case TICK_SIG:
+        {
+            ++me->nTicks;
+            break;
+        }
+        case PROBE_SIG:
+        {
+            l_dispNs += FreeAct_cyclesToNs(FreeAct_cycles() - ((ProbeEvt const*)e)->stamp);
+            xSemaphoreGive(l_probeDone);
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+}
+
+/** @brief Lowest-priority task soaking up the CPU time left over */
+static void spinner(void* arg)
+{
+    (void)arg;
+    for (;;)
+    {
+        ++l_spins;
+    }
+}
+
+/** @brief Spinner progress over one load window */
+static uint32_t measureSpins(void)
+{
+    l_spins = 0U;
+    vTaskDelay(pdMS_TO_TICKS(LOAD_WINDOW_MS));
+    return l_spins;
+}
+
+/**
+ * @brief Delete the first n AOs and the scheduler, and free their storage
+ *
+ * The benchmark task outranks every AO, so none of them is running.
+ */
+static void Bench_teardown(Mode mode, ActiveSched* sched, uint16_t n)
+{
+    uint32_t i;
+
+    for (i = 0U; i < n; ++i)
+    {
+        xTimerDelete(l_nodes[i]->tick.timer, portMAX_DELAY);
+        if (mode == MODE_THREAD)
+        {
+            vTaskDelete(l_nodes[i]->super.thread);
+        }
+        vQueueDelete(l_nodes[i]->super.queue);
+    }
+    if ((sched != (ActiveSched*)0) && (sched->thread != (TaskHandle_t)0))
+    {
+        vTaskDelete(sched->thread);
+    }
+    vTaskDelay(pdMS_TO_TICKS(50U));  // timer service processes the deletes
+    for (i = 0U; i < n; ++i)
+    {
+        heap_caps_free(l_nodes[i]);
+        l_nodes[i] = (Node*)0;
+    }
+    heap_caps_free(sched);
+}
+
+/**
+ * @brief Run one count in one mode
+ *
+ * @return false if the AOs do not fit in the heap
+ */
+static bool Bench_run(Mode mode, uint16_t n)
+{
+    size_t const   itemSize  = (mode == MODE_COOP) ? sizeof(SchedItem) : sizeof(Event*);
+    size_t const   queueSize = NODE_QUEUE_LEN * itemSize;
+    size_t const   stackSize = (mode == MODE_THREAD) ? NODE_STACK_SIZE : 0U;
+    size_t const   blockSize = sizeof(Node) + queueSize + stackSize;
+    uint32_t const period    = ((uint32_t)n * 1000U) / AGG_RATE_HZ;
+    ActiveSched*   sched     = (ActiveSched*)0;
+    uint32_t       postNs    = 0U;
+    uint32_t       ticks     = 0U;
+    size_t         free0;
+    size_t         ramPerAo;
+    uint32_t       spins;
+    uint32_t       i;
+
+    if ((((size_t)n * blockSize) + HEAP_RESERVE) > heap_caps_get_free_size(MALLOC_CAP_8BIT))
+    {
+        return false;
+    }
+    if (mode == MODE_COOP)
+    {
+        /* shared by all AOs: allocated outside the per-AO measurement */
+        sched = heap_caps_malloc(sizeof(ActiveSched) + SCHED_STACK_SIZE, MALLOC_CAP_8BIT);
+        if (sched == (ActiveSched*)0)
+        {
+            return false;
+        }
+        ActiveSched_ctor(sched, SCHED_FIXED_PRIO);
+    }
+
+    free0 = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    for (i = 0U; i < n; ++i)
+    {
+        Node* const me = heap_caps_malloc(blockSize, MALLOC_CAP_8BIT);
+        uint8_t*    queue;
+
+        if ((me == (Node*)0) || (heap_caps_get_free_size(MALLOC_CAP_8BIT) < HEAP_RESERVE))
+        {
+            heap_caps_free(me);
+            Bench_teardown(mode, sched, (uint16_t)i);
+            return false;
+        }
+        memset(me, 0, blockSize);
+        l_nodes[i] = me;
+        queue      = (uint8_t*)(me + 1);
+
+        Active_ctor(&me->super, (DispatchHandler)&Node_dispatch);
+        me->tick.type = TYPE_PERIODIC;
+        TimeEvent_ctor(&me->tick, TICK_SIG, &me->super);
+        if (mode == MODE_COOP)
+        {
+            /* no deadline: SCHED_FIXED_PRIO does not use it */
+            Active_attach(&me->super, sched, NODE_PRIO, 0U, (SchedItem*)queue, NODE_QUEUE_LEN);
+        }
+        else
+        {
+            Active_start(&me->super, NODE_PRIO, (Event**)queue, NODE_QUEUE_LEN, queue + queueSize, NODE_STACK_SIZE,
+                         0U);
+        }
+    }
+    ramPerAo = (free0 - heap_caps_get_free_size(MALLOC_CAP_8BIT)) / n;
+
+    if (mode == MODE_COOP)
+    {
+        ActiveSched_start(sched, NODE_PRIO, (uint8_t*)(sched + 1), SCHED_STACK_SIZE);
+    }
+    vTaskDelay(pdMS_TO_TICKS(50U));  // let INIT run everywhere
+
+    /* the benchmark task outranks the AOs, so Active_post() never switches */
+    l_dispNs = 0U;
+    for (i = 0U; i < N_PROBES; ++i)
+    {
+        Active* const  target = &l_nodes[i % n]->super;
+        uint32_t const t0     = FreeAct_cycles();
+
+        l_probe.stamp = t0;
+        Active_post(target, &l_probe.super);
+        postNs += FreeAct_cyclesToNs(FreeAct_cycles() - t0);
+        xSemaphoreTake(l_probeDone, portMAX_DELAY);
+    }
+
+    /* fixed aggregate rate: n AOs ticking every n/AGG_RATE_HZ seconds */
+    for (i = 0U; i < n; ++i)
+    {
+        TimeEvent_arm(&l_nodes[i]->tick, period);
+    }
+    spins = measureSpins();
+    for (i = 0U; i < n; ++i)
+    {
+        TimeEvent_disarm(&l_nodes[i]->tick);
+        ticks += l_nodes[i]->nTicks;
+    }
+
+    ESP_LOGI(TAG, "%-6s n=%4u ram/AO=%5u B post=%6lu ns dispatch=%7lu ns ticks=%5lu load=%5.1f%%",
+             (mode == MODE_COOP) ? "coop" : "thread", (unsigned)n, (unsigned)ramPerAo,
+             (unsigned long)(postNs / N_PROBES), (unsigned long)(l_dispNs / N_PROBES), (unsigned long)ticks,
+             100.0 * (1.0 - ((double)spins / l_idleSpins)));
+
+    Bench_teardown(mode, sched, n);
+    return true;
+}
+
+static void bench(void* arg)
+{
+    uint32_t i;
+
+    (void)arg;
+    FreeAct_cyclesCalibrate();
+    l_idleSpins = measureSpins();
+    for (i = 0U; (i < N_COUNTS) && Bench_run(MODE_THREAD, l_counts[i]); ++i)
+    {
+    }
+    for (i = 0U; (i < N_COUNTS) && Bench_run(MODE_COOP, l_counts[i]); ++i)
+    {
+    }
+    ESP_LOGI(TAG, "done");
+    vTaskDelete(NULL);
+}
+
+/**
+ * @brief Main application entry point
+ *
+ * @details
+ * Starts the load spinner and the benchmark task. The registry (watchdog)
+ * must stay disabled: it only grows, while this benchmark recycles AO
+ * storage between counts.
+ */
+void app_main()
+{
+    ESP_LOGI(TAG, "AO scaling benchmark: %u AOs max, %u Hz aggregate tick rate", (unsigned)l_counts[N_COUNTS - 1U],
+             (unsigned)AGG_RATE_HZ);
+
+    l_probeDone = xSemaphoreCreateBinary();
+    xTaskCreate(&spinner, "spin", 2048U, NULL, SPIN_PRIO + tskIDLE_PRIORITY, NULL);
+    xTaskCreate(&bench, "bench", 4096U, NULL, BENCH_PRIO + tskIDLE_PRIORITY, NULL);
+}
@@ -0,0 +1,167 @@
+
+/**
+ * @file main.c
+ * @brief EDF vs. fixed-priority deadline-miss benchmark
+ *
+ * @details
+ * Runs the same periodic task set twice on a cooperative ActiveSched:
+ * once with rate-monotonic fixed priorities (SCHED_FIXED_PRIO) and once
+ * with earliest-deadline-first (SCHED_EDF). Every job is released by its
+ * own esp_timer with a relative deadline equal to its period, burns its
+ * WCET in a busy loop, and the scheduler counts jobs completed late.
+ *
+ * The task set has a utilization of ~96%, above the rate-monotonic bound
+ * (~78% for three tasks) but below 100%, so EDF is expected to miss far
+ * fewer deadlines.
+ */
+
+#include "FreeAct.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+/** @brief Log tag for this module */
+#define TAG "edf_bench"
+
+/** @brief Duration of one benchmark run */
+#define BENCH_DURATION_MS 10000U
+
+/** @brief Event queue depth of every worker AO */
+#define WORKER_QUEUE_LEN 8U
+
+enum Signals
+{
+    WORK_SIG = USER_SIG,  ///< Job release
+};
+
+/** @brief Periodic task specification */
+typedef struct
+{
+    uint32_t periodMs;  ///< Release period, also the relative deadline
+    uint32_t wcetUs;    ///< Execution time burnt per job
+    uint8_t  prio;      ///< Rate-monotonic priority (shorter period = higher)
+} TaskSpec;
+
+/** @brief The task set: U = 3/8 + 4/12 + 5/20 = 0.958 */
+static TaskSpec const l_taskSet[] = {
+    {8U, 3000U, 3U},
+    {12U, 4000U, 2U},
+    {20U, 5000U, 1U},
+};
+
+#define N_TASKS (sizeof(l_taskSet) / sizeof(l_taskSet[0]))
+
+/** @brief Worker Active Object executing the jobs of one periodic task */
+typedef struct
+{
+    Active             super;    ///< Inherit Active base class
+    TaskSpec const*    spec;     ///< Task parameters
+    esp_timer_handle_t release;  ///< Periodic job release timer
+} Worker;
+
+/** @brief One benchmark run: a scheduler with its worker AOs */
+typedef struct
+{
+    ActiveSched sched;                                ///< Shared cooperative scheduler
+    Worker      workers[N_TASKS];                     ///< Worker AOs
+    SchedItem   queues[N_TASKS][WORKER_QUEUE_LEN];    ///< Worker event queues
+    StackType_t stack[configMINIMAL_STACK_SIZE * 4];  ///< Scheduler thread stack
+} Bench;
+
+static Event const l_workEvt = {WORK_SIG};
+
+static Bench l_fixedBench;
+static Bench l_edfBench;
+
+/** @brief Busy-wait for the given number of microseconds */
+static void burn(uint32_t us)
+{
+    int64_t const end = esp_timer_get_time() + us;
+    while (esp_timer_get_time() < end)
+    {
+    }
+}
+
+static void Worker_dispatch(Worker* const me, Event const* const e)
+{
+    switch (e->sig)
+    {
+        case WORK_SIG:
+        {
+            burn(me->spec->wcetUs);
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+}
+
+/** @brief esp_timer callback releasing one job with its deadline */
+static void Worker_release(void* arg)
+{
+    Worker* const me = (Worker*)arg;
+    Active_postDeadline(&me->super, &l_workEvt, me->spec->periodMs);
+}
+
+static void Worker_ctor(Worker* const me, TaskSpec const* spec)
+{
+    Active_ctor(&me->super, (DispatchHandler)&Worker_dispatch);
+    me->spec = spec;
+
+    esp_timer_create_args_t const args = {
+        .callback = &Worker_release,
+        .arg      = me,
+        .name     = "release",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&args, &me->release));
+}
+
+/**
+ * @brief Run the task set once under the given policy and report the results
+ */
+static void Bench_run(Bench* const b, SchedPolicy policy, char const* name)
+{
+    uint32_t i;
+
+    ActiveSched_ctor(&b->sched, policy);
+    for (i = 0U; i < N_TASKS; ++i)
+    {
+        Worker_ctor(&b->workers[i], &l_taskSet[i]);
+        Active_attach(&b->workers[i].super, &b->sched, l_taskSet[i].prio, l_taskSet[i].periodMs, b->queues[i],
+                      WORKER_QUEUE_LEN);
+    }
+    ActiveSched_start(&b->sched, 1U, b->stack, sizeof(b->stack));
+
+    for (i = 0U; i < N_TASKS; ++i)
+    {
+        ESP_ERROR_CHECK(esp_timer_start_periodic(b->workers[i].release, l_taskSet[i].periodMs * 1000U));
+    }
+    vTaskDelay(pdMS_TO_TICKS(BENCH_DURATION_MS));
+    for (i = 0U; i < N_TASKS; ++i)
+    {
+        ESP_ERROR_CHECK(esp_timer_stop(b->workers[i].release));
+    }
+    vTaskDelay(pdMS_TO_TICKS(100U));  // let the backlog drain
+
+    ESP_LOGI(TAG, "%-10s jobs=%lu missed=%lu (%.2f%%)", name, (unsigned long)b->sched.nDispatched,
+             (unsigned long)b->sched.nMissed,
+             (b->sched.nDispatched != 0U) ? (100.0 * b->sched.nMissed / b->sched.nDispatched) : 0.0);
+}
+
+/**
+ * @brief Main application entry point
+ *
+ * @details
+ * Runs the fixed-priority and the EDF benchmark back to back. The INIT
+ * events dispatched at scheduler start bypass the queues and are not
+ * counted as jobs.
+ */
+void app_main()
+{
+    ESP_LOGI(TAG, "EDF benchmark start: %u tasks, %u ms per run", (unsigned)N_TASKS, (unsigned)BENCH_DURATION_MS);
+
+    Bench_run(&l_fixedBench, SCHED_FIXED_PRIO, "fixed-prio");
+    Bench_run(&l_edfBench, SCHED_EDF, "EDF");
+}
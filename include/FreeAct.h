@@ -34,6 +34,9 @@
 #ifndef FREE_ACT_H
 #define FREE_ACT_H
 
+#include <stdbool.h>
+#include <time.h>
+
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
 #include "freertos/task.h"
@@ -63,13 +66,41 @@ typedef struct
     /* event parameters added in subclasses of Event */
 } Event;
 
+/* Coalesced Event class: accumulates ISR activity between dispatches */
+typedef struct
+{
+    Event         super;   /* inherit Event */
+    portMUX_TYPE  lock;    /* guards the accumulator (ISR vs. AO) */
+    uint32_t      count;   /* counts accumulated since the last consume */
+    uint32_t      flags;   /* flags OR-ed since the last consume */
+    bool volatile pending; /* posted and not yet consumed */
+} CoalescedEvent;
+
+void CoalescedEvent_ctor(CoalescedEvent* const me, Signal sig);
+void CoalescedEvent_consume(CoalescedEvent const* const me, uint32_t* count, uint32_t* flags);
+
 /*---------------------------------------------------------------------------*/
 /* Actvie Object facilities... */
 
-typedef struct Active Active; /* forward declaration */
+typedef struct Active      Active;      /* forward declaration */
+typedef struct ActiveSched ActiveSched; /* forward declaration */
+typedef struct ActivePool  ActivePool;  /* forward declaration */
 
 typedef void (*DispatchHandler)(Active* const me, Event const* const e);
 
+#if CONFIG_FREEACT_BLOCK_CHECK
+#include "FreeAct_blockhooks.h" /* FREEACT_BLOCK_... kinds */
+
+/* blocking observed during one dispatch */
+typedef struct
+{
+    void const* obj;       /* first object blocked on (queue, semaphore, event group), NULL for delay/notify */
+    uint8_t     kind;      /* FREEACT_BLOCK_... kind of that first block */
+    uint16_t    count;     /* number of times the handler blocked */
+    uint32_t    blockedUs; /* total time blocked */
+} DispatchBlock;
+#endif
+
 /* Active Object base class */
 struct Active
 {
@@ -80,6 +111,83 @@ struct Active
     StaticQueue_t queue_cb; /* queue control-block (FreeRTOS static alloc) */
 
     DispatchHandler dispatch; /* pointer to the dispatch() function */
+    uint8_t         prio;     /* priority (1-based) */
+
+#if CONFIG_FREEACT_COPY_EVENTS
+    uint8_t copySize; /* item size of a copy-in queue, 0: queue of Event pointers */
+#endif
+
+#if CONFIG_FREEACT_DISPATCH_GEN
+    uint32_t volatile gen; /* dispatch generation (odd while dispatching) */
+#endif
+
+#if CONFIG_FREEACT_REGISTRY
+    Active* regNext; /* next AO in the framework registry */
+#endif
+
+#if CONFIG_FREEACT_CURRENT
+    Event const* volatile curEvt; /* event being dispatched, NULL when idle */
+#endif
+
+#if CONFIG_FREEACT_BLOCK_CHECK
+    DispatchBlock blk;       /* blocking seen in the current dispatch */
+    int64_t       blkSince;  /* start of the current block (esp_timer us), 0 if not blocked */
+    bool          blkExempt; /* blocks by design, not reported */
+#endif
+
+#if CONFIG_FREEACT_WATCHDOG
+    Signal volatile curSig; /* signal being dispatched */
+    uint32_t        wdGen;  /* generation seen at the last watchdog check */
+#endif
+
+#if CONFIG_FREEACT_STARVATION
+    uint32_t   starveGen;      /* generation seen at the last starvation check */
+    uint32_t   waitGen;        /* generation by which the events queued at 'waitSince' are dispatched */
+    TickType_t waitSince;      /* check that saw those events queued */
+    bool       waiting;        /* events were queued at 'waitSince' */
+    bool       starveActive;   /* dispatched during the last period */
+    bool       starveReported; /* this waiting episode was reported */
+#endif
+
+#if CONFIG_FREEACT_ELASTIC_QUEUE
+    Event const**     ovfSto;   /* overflow ring, NULL if the queue is not elastic */
+    uint16_t          ovfLen;   /* capacity of the overflow ring */
+    uint16_t          ovfHead;  /* oldest event in the overflow ring */
+    uint16_t volatile ovfCount; /* events waiting in the overflow ring */
+    uint16_t          ovfPeak;  /* high-water mark of ovfCount */
+    portMUX_TYPE      ovfLock;  /* orders posts against draining */
+#endif
+
+#if CONFIG_FREEACT_BOOT_BARRIER
+    Active*  bootNext; /* next AO started before FreeAct_boot() */
+    uint32_t initUs;   /* duration of the INIT_SIG dispatch [us] */
+    int8_t   initCore; /* core that ran INIT_SIG, -1 if not initialized */
+    bool     bootWait; /* INIT_SIG waits for FreeAct_boot() */
+#endif
+
+#if CONFIG_FREEACT_PRIO_INHERIT
+    uint8_t  effPrio;   /* effective priority, >= prio while serving requests */
+    uint16_t nRequests; /* requests received and not yet replied to */
+#endif
+
+#if CONFIG_FREEACT_LAZY_AO
+    uint32_t         stackSize; /* stack allocated on activation [bytes] */
+    uint32_t         idleMs;    /* idle time before hibernation, 0 = never */
+    uint8_t volatile lazyState; /* ActiveLazyState */
+    bool             initDone;  /* INIT_SIG survived a hibernation */
+    portMUX_TYPE     lazyLock;  /* orders activation against hibernation */
+#endif
+
+#if CONFIG_FREEACT_COOP_SCHED
+    ActiveSched* sched;      /* shared scheduler, NULL for a private thread */
+    Active*      schedNext;  /* next AO sharing the same scheduler */
+    uint32_t     deadlineMs; /* default relative deadline of posted events */
+#endif
+
+#if CONFIG_FREEACT_SPAWN
+    ActivePool* pool;        /* pool the AO was spawned from, NULL if static */
+    bool        initPending; /* linked before the scheduler started, INIT_SIG not dispatched yet */
+#endif
 
     /* active object data added in subclasses of Active */
 };
@@ -89,26 +197,301 @@ void Active_start(Active* const me, uint8_t prio, /* priority (1-based) */
                   Event** queueSto, uint32_t queueLen, void* stackSto, uint32_t stackSize, uint16_t opt);
 void Active_post(Active* const me, Event const* const e);
 void Active_postFromISR(Active* const me, Event const* const e, BaseType_t* pxHigherPriorityTaskWoken);
+void Active_postFromISR_coalesced(Active* const me, CoalescedEvent* const e, uint32_t count, uint32_t flags,
+                                  BaseType_t* pxHigherPriorityTaskWoken);
+
+#if CONFIG_FREEACT_PRIO_INHERIT
+/* Request/reply with priority inheritance: a request raises the serving
+ * AO to the (effective) priority of the requesting AO, so medium-priority
+ * AOs cannot starve the reply. The server drops back to its own priority
+ * once it has replied to all outstanding requests. Along a request chain
+ * the boost is passed on by the requests made while boosted; a request
+ * the server had already posted further down the chain keeps the priority
+ * it was made with.
+ */
+void Active_postRequest(Active* const me, Event const* const e, Active const* const client);
+void Active_reply(Active* const me, Active* const client, Event const* const e);
+#endif
+
+#if CONFIG_FREEACT_LAZY_AO
+/* Lazy AO: only the queue exists after Active_startLazy(). The thread and
+ * its stack are allocated from the heap when the first event arrives and
+ * released again after 'idleMs' without events. The AO state survives
+ * hibernation; INIT_SIG is dispatched once, on the first activation.
+ */
+typedef enum
+{
+    LAZY_OFF,     /* regular AO with a permanent thread */
+    LAZY_DORMANT, /* no thread, waiting for the next event */
+    LAZY_RUNNING  /* thread allocated and running */
+} ActiveLazyState;
+
+void Active_startLazy(Active* const me, uint8_t prio, /* priority (1-based) */
+                      Event** queueSto, uint32_t queueLen, uint32_t stackSize, uint32_t idleMs);
+#endif
+
+#if CONFIG_FREEACT_BOOT_BARRIER
+/* Two-phase startup: AOs started before FreeAct_boot() only create their
+ * queue and thread. FreeAct_boot() then lets all of them dispatch INIT_SIG
+ * in parallel and releases them together into their event loops once every
+ * INIT_SIG has completed. AOs started after FreeAct_boot() initialize
+ * right away.
+ */
+void FreeAct_boot(void);
+void FreeAct_bootReport(void);
+#endif
+
+#if CONFIG_FREEACT_ELASTIC_QUEUE
+/* Optional overflow ring absorbing bursts the queue cannot hold. Events in
+ * the ring keep their order and are moved back into the queue as the AO
+ * consumes. The ring may live in PSRAM (e.g., EXT_RAM_BSS_ATTR).
+ */
+void     Active_setOverflow(Active* const me, Event const** ovfSto, uint32_t ovfLen);
+uint16_t Active_overflowPeak(Active const* const me);
+#endif
+
+#if CONFIG_FREEACT_COOP_SCHED
+void Active_postDeadline(Active* const me, Event const* const e, uint32_t deadlineMs);
+void Active_postDeadlineFromISR(Active* const me, Event const* const e, uint32_t deadlineMs,
+                                BaseType_t* pxHigherPriorityTaskWoken);
+#endif
+
+#if CONFIG_FREEACT_WATCHDOG
+/* One framework timer checks all AOs every 'periodMs': an AO must either be
+ * idle or have completed a dispatch since the previous check. Otherwise
+ * FreeAct_onWatchdog() is called (from the timer task) with the stuck AO
+ * and the signal it is handling.
+ */
+void FreeAct_watchdogStart(uint32_t periodMs);
+void FreeAct_onWatchdog(Active* const me, Signal sig); /* provided by the application */
+#endif
+
+#if CONFIG_FREEACT_COPY_EVENTS
+/* Copy-in queues: pass the item size (sizeof(Event) ... CONFIG_FREEACT_COPY_MAX)
+ * as Active_start()'s 'opt', with 'queueSto' pointing to queueLen * opt
+ * bytes. Active_postCopy() copies the first 'size' bytes of the event into
+ * the queue (the rest is zeroed); pass sizeof(Event) for a signal-only
+ * event. Active_post() to such an AO asserts, as it would drop the payload.
+ * TimeEvents are delivered as their signal only, so the handler must tell
+ * them apart by signal, not by address. Not for elastic queues, coalesced
+ * events or the framework AOs (Aggregator, AsyncIo, BusMgr), which rely on
+ * event pointers.
+ */
+void Active_postCopy(Active* const me, Event const* const e, uint16_t size);
+void Active_postCopyFromISR(Active* const me, Event const* const e, uint16_t size,
+                            BaseType_t* pxHigherPriorityTaskWoken);
+#endif
+
+#if CONFIG_FREEACT_ALLOC_CHECK
+/* Called by the allocating task (after the allocation) whenever an AO
+ * allocates from the heap inside its dispatch handler. It runs inside the
+ * allocator's hook, so it must neither allocate nor block: count, or log
+ * with ESP_DRAM_LOGW().
+ */
+void FreeAct_onDispatchAlloc(Active* const me, Signal sig, size_t size); /* provided by the application */
+#endif
+
+#if CONFIG_FREEACT_BLOCK_CHECK
+/* Called from the AO's thread after a dispatch handler that blocked (see
+ * FreeAct_blockhooks.h for enabling the kernel hooks).
+ */
+void FreeAct_onDispatchBlock(Active* const me, Signal sig, DispatchBlock const* blk); /* provided by the application */
+
+/* exempt an AO that blocks by design (AsyncIo and BusMgr exempt themselves) */
+void Active_allowBlocking(Active* const me);
+#endif
+
+#if CONFIG_FREEACT_STARVATION
+/* One framework timer checks all AOs every 'periodMs'. An AO whose oldest
+ * queued event has waited for 'nPeriods' periods or more (whether the AO
+ * dispatches nothing or just too slowly for its backlog) is reported to
+ * FreeAct_onStarvation() (from the timer task) with that age in periods,
+ * once per episode; the episode ends when its queue is found empty. The
+ * age is measured at the period resolution. 'culprit' is the AO on
+ * another thread of the highest FreeRTOS priority below the victim's
+ * thread that was dispatching meanwhile (priority inversion), or NULL if
+ * the victim was starved by something else (higher-priority tasks,
+ * interrupts). AOs sharing an ActiveSched run at the scheduler thread's
+ * priority; their priorities among themselves are not compared.
+ */
+void FreeAct_starvationStart(uint32_t periodMs, uint16_t nPeriods);
+void FreeAct_onStarvation(Active* const victim, Active* const culprit, uint16_t periods); /* provided by the application */
+#endif
+
+#if CONFIG_FREEACT_DISPATCH_GEN
+/* true while the AO is inside its dispatch handler */
+static inline bool Active_isDispatching(Active const* const me)
+{
+    return (me->gen & 1U) != 0U;
+}
+#endif
+
+#if CONFIG_FREEACT_CURRENT
+/* the AO dispatching an event on 'task' (NULL: the calling task) and that
+ * event, NULL if the task is not inside any dispatch; O(1), usable from
+ * ISRs and kernel hooks
+ */
+Active* Active_currentOf(TaskHandle_t task, Event const** e);
+#endif
+
+/*---------------------------------------------------------------------------*/
+/* Cooperative scheduler facilities... */
+
+#if CONFIG_FREEACT_COOP_SCHED
+
+/* AOs attached to an ActiveSched share one FreeRTOS task and run to
+ * completion one event at a time. Every queued event carries an absolute
+ * deadline; the policy decides which AO gets the next dispatch.
+ */
+typedef enum
+{
+    SCHED_FIXED_PRIO, /* highest AO priority with a pending event first */
+    SCHED_EDF         /* earliest head-of-queue deadline first */
+} SchedPolicy;
+
+/* queue item of an AO attached to a shared scheduler */
+typedef struct
+{
+    Event const* e;        /* the posted event */
+    int64_t      deadline; /* absolute deadline [us, esp_timer time base] */
+} SchedItem;
+
+/* Shared (cooperative) scheduler class */
+struct ActiveSched
+{
+    TaskHandle_t thread;    /* the one thread shared by all attached AOs */
+    StaticTask_t thread_cb; /* thread control-block (FreeRTOS static alloc) */
+
+    Active*      members; /* attached AOs (linked through schedNext) */
+    SchedPolicy  policy;  /* scheduling policy */
+    portMUX_TYPE lock;    /* guards 'members' against spawn/destroy */
+#if CONFIG_FREEACT_SPAWN
+    Active* retired; /* destroyed AOs, returned to their pools after the dispatch */
+#endif
+
+    uint32_t volatile nDispatched; /* events dispatched */
+    uint32_t volatile nMissed;     /* events completed after their deadline */
+};
+
+void ActiveSched_ctor(ActiveSched* const me, SchedPolicy policy);
+void ActiveSched_start(ActiveSched* const me, uint8_t prio, /* priority (1-based) */
+                       void* stackSto, uint32_t stackSize);
+void Active_attach(Active* const me, ActiveSched* const sched, uint8_t prio, uint32_t deadlineMs,
+                   SchedItem* queueSto, uint32_t queueLen);
+
+#endif /* CONFIG_FREEACT_COOP_SCHED */
 
 /*---------------------------------------------------------------------------*/
 /* Time Event facilities... */
 
-/* Time Event class */
+#if CONFIG_FREEACT_CALENDAR
+/* Cron-like recurring wall-clock schedule in local time (set TZ): the
+ * TimeEvent fires at every minute whose minute, hour, day of month, month
+ * and day of week bits are all set. E.g. every day at 02:00:
+ * {CAL_BIT(0), CAL_BIT(2), CAL_ANY_MDAY, CAL_ANY_MONTH, CAL_ANY_WDAY}
+ */
 typedef struct
+{
+    uint64_t minutes; /* bit n: minute n (0-59) */
+    uint32_t hours;   /* bit n: hour n (0-23) */
+    uint32_t mdays;   /* bit n: day of month n (1-31) */
+    uint16_t months;  /* bit n: month n (1-12) */
+    uint8_t  wdays;   /* bit n: day of week n (0 = Sunday) */
+} CalSchedule;
+
+#define CAL_BIT(n)     (1ULL << (n))
+#define CAL_ANY_MINUTE 0x0FFFFFFFFFFFFFFFULL
+#define CAL_ANY_HOUR   0x00FFFFFFU
+#define CAL_ANY_MDAY   0xFFFFFFFEU
+#define CAL_ANY_MONTH  0x1FFEU
+#define CAL_ANY_WDAY   0x7FU
+#endif
+
+/* Time Event class */
+typedef struct TimeEvent
 {
     Event         super;    /* inherit Event */
     Active*       act;      /* the AO that requested this TimeEvent */
     TimerHandle_t timer;    /* private timer handle */
     StaticTimer_t timer_cb; /* timer control-block (FreeRTOS static alloc) */
     TimerType_t   type;     /* timer type, periodic or one-shot */
+
+#if CONFIG_FREEACT_CALENDAR
+    time_t             at;        /* wall-clock expiry, 0 if not armed by the calendar */
+    CalSchedule const* cal;       /* recurring schedule, NULL for TimeEvent_armAt() */
+    struct TimeEvent*  calNext;   /* next calendar TimeEvent (clock change list) */
+    uint32_t           calGen;    /* arming generation, advanced by every arm and disarm */
+    TickType_t         calTicks;  /* period of the last TimeEvent_arm(), 0 if disarmed or calendar-armed */
+    bool               calLinked; /* in the clock change list */
+#endif
 } TimeEvent;
 
 void TimeEvent_ctor(TimeEvent* const me, Signal sig, Active* act);
-void TimeEvent_arm(TimeEvent* const me, uint32_t millisec);
-void TimeEvent_disarm(TimeEvent* const me);
+void TimeEvent_arm(TimeEvent* const me, uint32_t millisec); /* task context */
+void TimeEvent_disarm(TimeEvent* const me);                  /* task context */
+void TimeEvent_armFromISR(TimeEvent* const me, uint32_t millisec, BaseType_t* pxHigherPriorityTaskWoken);
+void TimeEvent_disarmFromISR(TimeEvent* const me, BaseType_t* pxHigherPriorityTaskWoken);
+
+/* static (i.e., class-wide) operations */
+void       TimeEvent_tickFromISR(BaseType_t* pxHigherPriorityTaskWoken);
+TickType_t TimeEvent_msToTicks(uint32_t millisec); /* at least one tick */
+
+#if CONFIG_FREEACT_CALENDAR
+/* Wall-clock arming of one-shot TimeEvents (task context). The FreeRTOS
+ * timer is armed for the remaining time (at most a day at once) and
+ * re-checked against the real-time clock on expiry, so the TimeEvent is
+ * posted once, when the wall clock reaches the expiry. TimeEvent_arm() and
+ * the disarm functions cancel the calendar arming.
+ */
+void   TimeEvent_armAt(TimeEvent* const me, time_t when);
+void   TimeEvent_armCal(TimeEvent* const me, CalSchedule const* sched); /* recurring */
+time_t CalSchedule_next(CalSchedule const* const s, time_t after);     /* (time_t)-1 if never */
+
+/* call after the real-time clock was set or stepped (settimeofday(), the
+ * SNTP sync notification): re-arms every calendar TimeEvent and
+ * recomputes the next occurrence of the recurring ones. Occurrences of a
+ * recurring TimeEvent that a forward step jumps over are skipped, not
+ * posted late; after a backward step, an occurrence already posted can
+ * come again. A TimeEvent_armAt() expiry that was stepped over is posted
+ * at once.
+ */
+void FreeAct_clockChanged(void);
+#endif
+
+/*---------------------------------------------------------------------------*/
+/* Dynamic Active Object facilities... */
+
+#if CONFIG_FREEACT_SPAWN
+
+/* Pool of preallocated AO instances (each with its queue and an optional
+ * TimeEvent) run by one ActiveSched: spawning never creates a FreeRTOS
+ * task. A spawned AO receives INIT_SIG from the scheduler thread; its
+ * subclass data is zeroed and should be set up from its events. Events
+ * posted to a destroyed AO are dropped.
+ */
+struct ActivePool
+{
+    ActiveSched* sched;      /* scheduler running the spawned AOs */
+    uint8_t*     instSto;    /* nInst instances of instSize bytes each */
+    uint16_t     instSize;   /* size of one instance (Active subclass) */
+    uint16_t     nInst;      /* number of instances */
+    uint16_t     nUsed;      /* instances currently spawned */
+    uint8_t      prio;       /* priority of the spawned AOs */
+    uint32_t     deadlineMs; /* default relative deadline of the spawned AOs */
+    TimeEvent*   timerSto;   /* one TimeEvent per instance, or NULL */
+    Active*      freeList;   /* free instances (linked through schedNext) */
+    portMUX_TYPE lock;       /* guards the free list */
+};
+
+void       ActivePool_ctor(ActivePool* const me, ActiveSched* const sched, uint8_t prio, uint32_t deadlineMs,
+                           void* instSto, uint16_t instSize, uint16_t nInst, SchedItem* queueSto, uint16_t queueLen);
+void       ActivePool_setTimers(ActivePool* const me, TimeEvent* timerSto, Signal sig);
+TimeEvent* ActivePool_timer(ActivePool const* const me, Active const* const act);
+
+Active* Active_spawn(ActivePool* const pool, DispatchHandler dispatch); /* NULL if exhausted */
+void    Active_destroy(Active* const me); /* from the scheduler's thread only */
 
-/* static (i.e., class-wide) operation */
-void TimeEvent_tickFromISR(BaseType_t* pxHigherPriorityTaskWoken);
+#endif /* CONFIG_FREEACT_SPAWN */
 
 /*---------------------------------------------------------------------------*/
 /* Assertion facilities... */
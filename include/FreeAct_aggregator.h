@@ -0,0 +1,59 @@
+/*****************************************************************************
+ * FreeAct windowed aggregation Active Object
+ *
+ * The Aggregator collects numeric SampleEvt events over a count and/or time
+ * window and posts one SummaryEvt (min, max, mean, count) per window to the
+ * target AO, so downstream AOs dispatch once per window instead of once
+ * per sample.
+ *
+ * MIT License, see FreeAct.h
+ *****************************************************************************/
+#ifndef FREE_ACT_AGGREGATOR_H
+#define FREE_ACT_AGGREGATOR_H
+
+#include "FreeAct.h"
+
+/* numeric sample consumed by the Aggregator */
+typedef struct
+{
+    Event   super; /* inherit Event */
+    int32_t value; /* sample value (fixed-point as needed) */
+} SampleEvt;
+
+/* summary of one window, posted to the target AO */
+typedef struct
+{
+    Event    super; /* inherit Event */
+    int32_t  min;   /* smallest sample in the window */
+    int32_t  max;   /* largest sample in the window */
+    int32_t  mean;  /* arithmetic mean, rounded toward zero */
+    uint32_t count; /* number of samples in the window */
+} SummaryEvt;
+
+/* Aggregator Active Object class */
+typedef struct
+{
+    Active super; /* inherit Active */
+
+    TimeEvent te;          /* periodic window timer (time windows only) */
+    Active*   target;      /* AO receiving the summaries */
+    Signal    sampleSig;   /* signal of the SampleEvt events to aggregate */
+    uint32_t  windowCount; /* samples per window, 0 for time windows only */
+    uint32_t  windowMs;    /* window length [ms], 0 for count windows only */
+
+    int64_t  sum;   /* running sum of the current window */
+    int32_t  min;   /* running minimum of the current window */
+    int32_t  max;   /* running maximum of the current window */
+    uint32_t count; /* samples in the current window */
+
+    /* Summaries alternate between two buffers: the target must consume a
+     * summary before the window after the next one closes.
+     */
+    SummaryEvt out[2];
+    uint8_t    outIdx;
+} Aggregator;
+
+void Aggregator_ctor(Aggregator* const me, Signal sampleSig, Active* target, Signal summarySig, uint32_t windowCount,
+                     uint32_t windowMs);
+
+#endif /* FREE_ACT_AGGREGATOR_H */
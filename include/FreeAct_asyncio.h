@@ -0,0 +1,58 @@
+/*****************************************************************************
+ * FreeAct asynchronous file and flash I/O
+ *
+ * AsyncIo is an AO dedicated to blocking storage operations: VFS files
+ * (SPIFFS, LittleFS, FAT, or regular files on host builds) and NVS. Other
+ * AOs post an AsyncIoReq to it and keep dispatching; when the operation is
+ * done, the very same request is posted back to the requester as the
+ * completion event carrying the result.
+ *
+ * MIT License, see FreeAct.h
+ *****************************************************************************/
+#ifndef FREE_ACT_ASYNCIO_H
+#define FREE_ACT_ASYNCIO_H
+
+#include <stddef.h>
+
+#include "FreeAct.h"
+#include "esp_err.h"
+
+typedef enum
+{
+    AIO_READ,     /* read 'len' bytes of file 'path' at 'offset' */
+    AIO_WRITE,    /* write 'len' bytes to file 'path' at 'offset' (created if missing) */
+    AIO_APPEND,   /* append 'len' bytes to file 'path' */
+    AIO_NVS_GET,  /* read blob 'key' of namespace 'path' (up to 'len' bytes) */
+    AIO_NVS_SET,  /* write blob 'key' of namespace 'path' and commit */
+    AIO_NVS_ERASE /* erase 'key' of namespace 'path' and commit */
+} AsyncIoOp;
+
+/* I/O request, posted back to the requester as its completion event */
+typedef struct
+{
+    Event       super;  /* inherit Event: the completion signal */
+    Active*     act;    /* requester receiving the completion */
+    AsyncIoOp   op;     /* operation */
+    char const* path;   /* file path, or NVS namespace */
+    char const* key;    /* NVS key (NVS operations only) */
+    void*       buf;    /* data buffer, owned by the requester */
+    size_t      len;    /* buffer length [bytes] */
+    long        offset; /* file offset (AIO_READ/AIO_WRITE) */
+    int32_t     result; /* bytes transferred, or -errno (files) / -EIO (NVS) on failure */
+    esp_err_t   err;    /* ESP_OK, the NVS error, or ESP_FAIL for a failed file operation */
+} AsyncIoReq;
+
+/* Async I/O Active Object class */
+typedef struct
+{
+    Active super; /* inherit Active */
+} AsyncIo;
+
+void AsyncIo_ctor(AsyncIo* const me);
+
+/* Submit a request (from an AO dispatch or any task). The request and the
+ * buffer must stay untouched until the completion event arrives.
+ */
+void AsyncIo_submit(AsyncIo* const me, AsyncIoReq* const req);
+
+#endif /* FREE_ACT_ASYNCIO_H */
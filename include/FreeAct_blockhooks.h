@@ -0,0 +1,58 @@
+/*****************************************************************************
+ * FreeAct blocking-call detector: FreeRTOS trace hooks
+ *
+ * The FreeRTOS kernel has to be compiled with these trace macros, so this
+ * header is force-included into every source file of the build. Add to the
+ * project CMakeLists.txt, before project():
+ *
+ *   idf_build_set_property(COMPILE_OPTIONS
+ *       "-include;${CMAKE_CURRENT_LIST_DIR}/components/freeact/include/FreeAct_blockhooks.h" APPEND)
+ *
+ * (adjust the path to where the FreeAct component lives). It has to stay
+ * free of includes, as it precedes everything else.
+ *
+ * MIT License, see FreeAct.h
+ *****************************************************************************/
+#ifndef FREE_ACT_BLOCKHOOKS_H
+#define FREE_ACT_BLOCKHOOKS_H
+
+#ifndef __ASSEMBLER__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* what a dispatch handler blocked on */
+enum
+{
+    FREEACT_BLOCK_QUEUE_RECEIVE, /* queue, semaphore or mutex take */
+    FREEACT_BLOCK_QUEUE_PEEK,    /* queue peek */
+    FREEACT_BLOCK_QUEUE_SEND,    /* queue send, semaphore give */
+    FREEACT_BLOCK_DELAY,         /* vTaskDelay(), vTaskDelayUntil() */
+    FREEACT_BLOCK_NOTIFY,        /* task notification wait */
+    FREEACT_BLOCK_EVENT_GROUP    /* event group wait or sync */
+};
+
+void FreeAct_blockHook(void const* obj, int kind);
+void FreeAct_switchedInHook(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define traceBLOCKING_ON_QUEUE_RECEIVE(pxQueue) FreeAct_blockHook((pxQueue), FREEACT_BLOCK_QUEUE_RECEIVE)
+#define traceBLOCKING_ON_QUEUE_PEEK(pxQueue)    FreeAct_blockHook((pxQueue), FREEACT_BLOCK_QUEUE_PEEK)
+#define traceBLOCKING_ON_QUEUE_SEND(pxQueue)    FreeAct_blockHook((pxQueue), FREEACT_BLOCK_QUEUE_SEND)
+#define traceTASK_DELAY()                       FreeAct_blockHook((void const*)0, FREEACT_BLOCK_DELAY)
+#define traceTASK_DELAY_UNTIL(xTimeToWake)      FreeAct_blockHook((void const*)0, FREEACT_BLOCK_DELAY)
+#define traceTASK_NOTIFY_TAKE_BLOCK(...)        FreeAct_blockHook((void const*)0, FREEACT_BLOCK_NOTIFY)
+#define traceTASK_NOTIFY_WAIT_BLOCK(...)        FreeAct_blockHook((void const*)0, FREEACT_BLOCK_NOTIFY)
+#define traceEVENT_GROUP_WAIT_BITS_BLOCK(xEventGroup, uxBitsToWaitFor) \
+    FreeAct_blockHook((xEventGroup), FREEACT_BLOCK_EVENT_GROUP)
+#define traceEVENT_GROUP_SYNC_BLOCK(xEventGroup, uxBitsToSet, uxBitsToWaitFor) \
+    FreeAct_blockHook((xEventGroup), FREEACT_BLOCK_EVENT_GROUP)
+#define traceTASK_SWITCHED_IN() FreeAct_switchedInHook()
+
+#endif /* __ASSEMBLER__ */
+
+#endif /* FREE_ACT_BLOCKHOOKS_H */
@@ -0,0 +1,65 @@
+/*****************************************************************************
+ * FreeAct bus transaction manager
+ *
+ * BusMgr is an AO owning one SPI/I2C bus. AOs post BusTxn requests to it
+ * instead of blocking in driver calls. Adjacent queued transactions to the
+ * same device are merged into one batch and handed to the bus backend,
+ * which runs them back-to-back under a single bus acquisition. Each
+ * request is then posted back to its requester as the completion event.
+ *
+ * The backend is a plain function table, so targets plug in a driver
+ * (see FreeAct_bus_spi.h) and host builds plug in a mock (see
+ * FreeAct_bus_mock.h). BusMgr drains its own queue while batching, so it
+ * needs a private, plain queue: not attached to an ActiveSched, not
+ * elastic and not copy-in.
+ *
+ * MIT License, see FreeAct.h
+ *****************************************************************************/
+#ifndef FREE_ACT_BUS_H
+#define FREE_ACT_BUS_H
+
+#include <stddef.h>
+
+#include "FreeAct.h"
+#include "esp_err.h"
+
+/* bus transaction, posted back to the requester as its completion event */
+typedef struct
+{
+    Event       super;  /* inherit Event: the completion signal */
+    Active*     act;    /* requester receiving the completion */
+    void*       dev;    /* backend device handle */
+    void const* tx;     /* bytes to send, or NULL */
+    void*       rx;     /* receive buffer, or NULL */
+    size_t      len;    /* transfer length [bytes] */
+    uint32_t    flags;  /* backend-specific flags */
+    esp_err_t   result; /* completion status */
+} BusTxn;
+
+/* bus backend: run 'n' transactions to the same device back-to-back,
+ * setting each 'result'
+ */
+typedef struct
+{
+    void (*run)(void* ctx, void* dev, BusTxn* const* txns, uint8_t n);
+} BusBackend;
+
+/* Bus Manager Active Object class */
+typedef struct
+{
+    Active super; /* inherit Active */
+
+    BusBackend const* backend;  /* bus driver */
+    void*             ctx;      /* backend context */
+    uint32_t          nBatches; /* batches run on the bus */
+    uint32_t          nTxns;    /* transactions run on the bus */
+} BusMgr;
+
+void BusMgr_ctor(BusMgr* const me, BusBackend const* backend, void* ctx);
+
+/* Submit a transaction (from an AO dispatch or any task). The request and
+ * its buffers must stay untouched until the completion event arrives.
+ */
+void BusMgr_submit(BusMgr* const me, BusTxn* const txn);
+
+#endif /* FREE_ACT_BUS_H */
@@ -0,0 +1,30 @@
+/*****************************************************************************
+ * FreeAct bus transaction manager: mock backend
+ *
+ * Completes every transaction without hardware, for host (linux target)
+ * builds and tests. Receive buffers get a loopback copy of the transmit
+ * buffer (or zeros), and every batch is counted, so tests can check the
+ * batching and the completion events.
+ *
+ * MIT License, see FreeAct.h
+ *****************************************************************************/
+#ifndef FREE_ACT_BUS_MOCK_H
+#define FREE_ACT_BUS_MOCK_H
+
+#include "FreeAct_bus.h"
+
+/* backend context: one per BusMgr */
+typedef struct
+{
+    esp_err_t result;  /* result given to every transaction */
+    uint32_t  nRuns;   /* batches run */
+    uint32_t  nTxns;   /* transactions run */
+    void*     lastDev; /* device of the last batch */
+    uint8_t   lastN;   /* size of the last batch */
+} BusMock;
+
+void BusMock_ctor(BusMock* const me, esp_err_t result);
+
+extern BusBackend const BusMock_backend;
+
+#endif /* FREE_ACT_BUS_MOCK_H */
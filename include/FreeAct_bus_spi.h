@@ -0,0 +1,25 @@
+/*****************************************************************************
+ * FreeAct bus transaction manager: SPI master backend
+ *
+ * Queues a whole batch to the SPI master driver (DMA-capable) under one
+ * spi_device_acquire_bus(), so the transactions run back-to-back.
+ * BusTxn.dev is the spi_device_handle_t, BusTxn.flags the
+ * spi_transaction_t flags.
+ *
+ * MIT License, see FreeAct.h
+ *****************************************************************************/
+#ifndef FREE_ACT_BUS_SPI_H
+#define FREE_ACT_BUS_SPI_H
+
+#include "FreeAct_bus.h"
+#include "driver/spi_master.h"
+
+/* backend context: one per BusMgr */
+typedef struct
+{
+    spi_transaction_t trans[CONFIG_FREEACT_BUS_BATCH_MAX]; /* driver descriptors */
+} BusSpi;
+
+extern BusBackend const BusSpi_backend;
+
+#endif /* FREE_ACT_BUS_SPI_H */
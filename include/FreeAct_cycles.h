@@ -0,0 +1,56 @@
+/*****************************************************************************
+ * FreeAct cycle counter
+ *
+ * A cheap timestamp for instrumentation and benchmarks: the CPU cycle
+ * counter (CCOUNT on Xtensa, the mcycle CSR on RISC-V, both read through
+ * esp_cpu_get_cycle_count()) on target, and CLOCK_MONOTONIC nanoseconds on
+ * the linux (host) target. Readings are 32 bits wide and only differences
+ * are meaningful; at 240 MHz they wrap after ~17 s, and the host's
+ * nanoseconds wrap after ~4.3 s, so keep measured intervals shorter.
+ *
+ * The counters are per core and not synchronized between cores, so take
+ * both readings of a difference on the same core (use FreeAct_time() of
+ * the trace for cross-core stamps). The rate follows the CPU clock: with
+ * dynamic frequency scaling enabled, conversions to ns are approximate.
+ *
+ * MIT License, see FreeAct.h
+ *****************************************************************************/
+#ifndef FREE_ACT_CYCLES_H
+#define FREE_ACT_CYCLES_H
+
+#include <stdint.h>
+
+#include "sdkconfig.h"
+
+#if CONFIG_IDF_TARGET_LINUX
+#include <time.h>
+#else
+#include "esp_cpu.h"
+#endif
+
+static inline uint32_t FreeAct_cycles(void)
+{
+#if CONFIG_IDF_TARGET_LINUX
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec); /* wraps every ~4.3 s */
+#else
+    return (uint32_t)esp_cpu_get_cycle_count();
+#endif
+}
+
+/* Measures the counter rate and the cost of one FreeAct_cycles() call.
+ * Busy-waits ~10 ms; called implicitly by the first FreeAct_cyclesToNs(),
+ * call it at startup to keep that out of a measurement.
+ */
+void FreeAct_cyclesCalibrate(void);
+
+uint32_t FreeAct_cyclesHz(void);       /* counter rate */
+uint32_t FreeAct_cyclesOverhead(void); /* cycles one reading adds to a difference */
+
+/* converts the difference of two FreeAct_cycles() readings to nanoseconds,
+ * less the cost of the reading itself
+ */
+uint32_t FreeAct_cyclesToNs(uint32_t cycles);
+
+#endif /* FREE_ACT_CYCLES_H */
@@ -0,0 +1,60 @@
+/*****************************************************************************
+ * FreeAct time-triggered cyclic executive
+ *
+ * Periodic AOs are activated from a static, precomputed frame table. A
+ * hardware-backed esp_timer releases one minor frame per period and posts
+ * the frame's activation events; event-driven AOs (at lower priorities)
+ * fill the slack between activations.
+ *
+ * MIT License, see FreeAct.h
+ *****************************************************************************/
+#ifndef FREE_ACT_CYCLIC_H
+#define FREE_ACT_CYCLIC_H
+
+#include "FreeAct.h"
+#include "esp_timer.h"
+
+/* one activation inside a minor frame */
+typedef struct
+{
+    Active*      act; /* periodic AO to activate */
+    Event const* evt; /* activation event posted to the AO */
+} CyclicSlot;
+
+/* minor frame: activations released together at the frame boundary */
+typedef struct
+{
+    CyclicSlot const* slots;  /* activations of this frame */
+    uint16_t          nSlots; /* number of activations */
+} CyclicFrame;
+
+/* per-frame run-time statistics */
+typedef struct
+{
+    uint32_t nReleases;    /* number of times the frame was released */
+    uint32_t nOverruns;    /* frame work not complete at the next boundary */
+    uint32_t nSkipped;     /* activations dropped because the AO was busy */
+    uint32_t lastJitterUs; /* release jitter of the last release [us] */
+    uint32_t maxJitterUs;  /* worst release jitter seen so far [us] */
+} CyclicFrameStats;
+
+/* Cyclic executive class */
+typedef struct
+{
+    CyclicFrame const* frames;   /* static frame table (major cycle) */
+    CyclicFrameStats*  stats;    /* per-frame statistics, nFrames entries */
+    uint16_t           nFrames;  /* number of minor frames in the table */
+    uint16_t           curr;     /* index of the last released frame */
+    uint32_t           periodUs; /* minor frame period [us] */
+    uint64_t           nTicks;   /* frames released since start */
+    int64_t            t0;       /* ideal release time of frame #0 [us] */
+    esp_timer_handle_t timer;    /* private hardware-backed timer */
+} CyclicExec;
+
+void CyclicExec_ctor(CyclicExec* const me, CyclicFrame const* frames, CyclicFrameStats* stats, uint16_t nFrames,
+                     uint32_t periodUs);
+void CyclicExec_start(CyclicExec* const me);
+void CyclicExec_stop(CyclicExec* const me);
+void CyclicExec_report(CyclicExec const* const me);
+
+#endif /* FREE_ACT_CYCLIC_H */
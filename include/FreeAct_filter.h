@@ -0,0 +1,38 @@
+/*****************************************************************************
+ * FreeAct event-stream filters: debounce, throttle and sample
+ *
+ * An EventFilter sits between a noisy producer and an AO. The producer
+ * posts to the filter instead of the AO; the filter forwards a thinned-out
+ * stream using a private FreeRTOS timer, the same way TimeEvents do.
+ *
+ * MIT License, see FreeAct.h
+ *****************************************************************************/
+#ifndef FREE_ACT_FILTER_H
+#define FREE_ACT_FILTER_H
+
+#include "FreeAct.h"
+
+typedef enum
+{
+    FILTER_DEBOUNCE, /* forward the latest event after N ms of quiet */
+    FILTER_THROTTLE, /* forward at most one event per N ms (leading edge) */
+    FILTER_SAMPLE    /* forward the latest event, if any, every N ms */
+} FilterMode;
+
+/* Event Filter class */
+typedef struct
+{
+    Active*               act;      /* the AO receiving the filtered stream */
+    Event const* volatile latest;   /* last event held back by the filter */
+    TimerHandle_t         timer;    /* private timer handle */
+    StaticTimer_t         timer_cb; /* timer control-block (FreeRTOS static alloc) */
+    portMUX_TYPE          lock;     /* guards the filter state */
+    FilterMode            mode;     /* filter operation */
+    bool volatile         busy;     /* throttle window open / sampler running */
+} EventFilter;
+
+void EventFilter_ctor(EventFilter* const me, FilterMode mode, Active* act, uint32_t millisec);
+void EventFilter_post(EventFilter* const me, Event const* const e);
+void EventFilter_postFromISR(EventFilter* const me, Event const* const e, BaseType_t* pxHigherPriorityTaskWoken);
+
+#endif /* FREE_ACT_FILTER_H */
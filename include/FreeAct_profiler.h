@@ -0,0 +1,42 @@
+/*****************************************************************************
+ * FreeAct sampling profiler
+ *
+ * A gptimer interrupt samples, for every core, the running task and the
+ * AO/signal it is dispatching (see Active_currentOf(), one thread-local
+ * storage read per core) and counts the sample in a fixed table keyed by
+ * task, AO, dispatch handler and signal. Nothing is recorded on the
+ * dispatch path itself beyond the current AO and event, and the ISR cost
+ * does not depend on the number of AOs, so the profiler can stay enabled
+ * in production builds.
+ *
+ * The interrupted program counter is not recorded: the timer ISR runs
+ * behind the interrupt dispatcher and cannot portably recover it. The
+ * dispatch handler address stands in as the "function" frame.
+ *
+ * MIT License, see FreeAct.h
+ *****************************************************************************/
+#ifndef FREE_ACT_PROFILER_H
+#define FREE_ACT_PROFILER_H
+
+#include "FreeAct.h"
+
+/* one profile entry */
+typedef struct
+{
+    TaskHandle_t    task;                          /* sampled task, NULL for an unused entry */
+    char            name[configMAX_TASK_NAME_LEN]; /* its name (the task may be gone by the dump) */
+    Active const*   act;                           /* dispatching AO, NULL outside any dispatch */
+    DispatchHandler fn;                            /* its dispatch handler */
+    Signal          sig;                           /* the signal being dispatched */
+    uint32_t        count;                         /* samples */
+} ProfileEntry;
+
+void FreeAct_profilerStart(uint32_t hz); /* sampling rate per core */
+void FreeAct_profilerStop(void);
+
+/* prints the profile to stdout as folded stacks
+ * ("task;AO;handler;signal count" - feed to flamegraph.pl) and clears it
+ */
+void FreeAct_profilerDump(void);
+
+#endif /* FREE_ACT_PROFILER_H */
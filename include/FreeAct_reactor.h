@@ -0,0 +1,63 @@
+/*****************************************************************************
+ * FreeAct I/O reactor
+ *
+ * One reactor thread multiplexes many sockets/file descriptors with
+ * select() (lwIP/VFS on target, POSIX on host) and turns readiness into
+ * IoEvents posted to the owning AOs. Watches are one-shot: after an IoEvent
+ * is posted the descriptor is not watched again until the owner has done
+ * its non-blocking I/O and called Reactor_rearm(), so a busy socket cannot
+ * flood its owner's queue.
+ *
+ * MIT License, see FreeAct.h
+ *****************************************************************************/
+#ifndef FREE_ACT_REACTOR_H
+#define FREE_ACT_REACTOR_H
+
+#include "FreeAct.h"
+
+/* readiness flags */
+enum
+{
+    REACTOR_READ  = (1U << 0), /* readable (or peer closed) */
+    REACTOR_WRITE = (1U << 1), /* writable */
+    REACTOR_ERROR = (1U << 2)  /* descriptor is no longer valid */
+};
+
+/* readiness event posted to the owner AO */
+typedef struct
+{
+    Event   super; /* inherit Event */
+    int     fd;    /* the ready descriptor */
+    uint8_t ready; /* REACTOR_READ | REACTOR_WRITE | REACTOR_ERROR */
+} IoEvent;
+
+/* one watched descriptor */
+typedef struct
+{
+    IoEvent       evt;      /* event posted on readiness */
+    Active*       owner;    /* AO owning the descriptor, NULL if unused */
+    uint8_t       interest; /* REACTOR_READ and/or REACTOR_WRITE */
+    bool volatile armed;    /* watched by the reactor right now */
+    int           selFd;    /* descriptor in the current select() sets, -1 if none (reactor thread) */
+} ReactorWatch;
+
+/* Reactor class */
+typedef struct
+{
+    TaskHandle_t thread;    /* the reactor thread (may block in select) */
+    StaticTask_t thread_cb; /* thread control-block (FreeRTOS static alloc) */
+
+    ReactorWatch* watches;  /* watch slots - provided by user */
+    uint16_t      nWatches; /* number of watch slots */
+    uint32_t      pollMs;   /* select() timeout; bounds the latency of (re)arming */
+    portMUX_TYPE  lock;     /* guards the watch slots */
+} Reactor;
+
+void          Reactor_ctor(Reactor* const me, ReactorWatch* watchSto, uint16_t nWatches, uint32_t pollMs);
+void          Reactor_start(Reactor* const me, uint8_t prio, /* priority (1-based) */
+                            void* stackSto, uint32_t stackSize);
+ReactorWatch* Reactor_watch(Reactor* const me, int fd, uint8_t interest, Active* owner, Signal sig);
+void          Reactor_rearm(Reactor* const me, ReactorWatch* const w);
+void          Reactor_unwatch(Reactor* const me, ReactorWatch* const w);
+
+#endif /* FREE_ACT_REACTOR_H */
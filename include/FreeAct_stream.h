@@ -0,0 +1,116 @@
+/*****************************************************************************
+ * FreeAct stream operators
+ *
+ * Statically allocated operators (map, filter, scan, merge, zip, window)
+ * chained into a pipeline that runs synchronously inside one AO dispatch.
+ * Values flow between operators by direct calls; only a StreamSink at the
+ * pipeline boundary posts events to another AO.
+ *
+ * Usage inside a dispatch handler:
+ *     Stream_push(&me->head.super, ((SampleEvt const*)e)->value);
+ *
+ * MIT License, see FreeAct.h
+ *****************************************************************************/
+#ifndef FREE_ACT_STREAM_H
+#define FREE_ACT_STREAM_H
+
+#include "FreeAct.h"
+#include "FreeAct_aggregator.h" /* SampleEvt */
+
+typedef struct Stream Stream; /* forward declaration */
+
+typedef void (*StreamPushFn)(Stream* const me, int32_t value);
+typedef int32_t (*StreamMapFn)(int32_t value);
+typedef bool (*StreamPredFn)(int32_t value);
+typedef int32_t (*StreamReduceFn)(int32_t acc, int32_t value);
+
+/* Stream operator base class */
+struct Stream
+{
+    StreamPushFn push; /* operator behavior */
+    Stream*      next; /* downstream operator, NULL drops the values */
+};
+
+/* feed one value into an operator */
+static inline void Stream_push(Stream* const me, int32_t value)
+{
+    (*me->push)(me, value);
+}
+
+/* connect the output of 'me' to the input of 'next' */
+void Stream_connect(Stream* const me, Stream* const next);
+
+/* map: forwards fn(value) */
+typedef struct
+{
+    Stream      super; /* inherit Stream */
+    StreamMapFn fn;    /* transformation */
+} StreamMap;
+
+/* filter: forwards the values for which pred(value) holds */
+typedef struct
+{
+    Stream       super; /* inherit Stream */
+    StreamPredFn pred;  /* predicate */
+} StreamFilter;
+
+/* scan: forwards the running accumulation acc = fn(acc, value) */
+typedef struct
+{
+    Stream         super; /* inherit Stream */
+    StreamReduceFn fn;    /* accumulator */
+    int32_t        acc;   /* running state */
+} StreamScan;
+
+/* merge: forwards the values of every operator connected to it */
+typedef struct
+{
+    Stream super; /* inherit Stream */
+} StreamMerge;
+
+/* zip: pairs the values of two inputs and forwards fn(left, right) */
+typedef struct
+{
+    Stream         super; /* inherit Stream (output side) */
+    Stream         left;  /* left input port */
+    Stream         right; /* right input port */
+    StreamReduceFn fn;    /* combiner */
+    int32_t        lval;  /* unpaired left value */
+    int32_t        rval;  /* unpaired right value */
+    bool           lfull; /* lval is valid */
+    bool           rfull; /* rval is valid */
+} StreamZip;
+
+/* window: forwards one reduction per tumbling window of 'size' values */
+typedef struct
+{
+    Stream         super; /* inherit Stream */
+    StreamReduceFn fn;    /* reducer */
+    int32_t        seed;  /* initial accumulator of every window */
+    int32_t        acc;   /* accumulator of the current window */
+    uint32_t       size;  /* values per window */
+    uint32_t       count; /* values in the current window */
+} StreamWindow;
+
+/* sink: posts every value as a SampleEvt to an AO (the pipeline boundary).
+ * Events are taken round-robin from 'sto'; make it deeper than the
+ * target's worst backlog.
+ */
+typedef struct
+{
+    Stream     super; /* inherit Stream */
+    Active*    act;   /* receiving AO */
+    SampleEvt* sto;   /* event storage */
+    uint16_t   len;   /* number of events in 'sto' */
+    uint16_t   idx;   /* next event to use */
+} StreamSink;
+
+void StreamMap_ctor(StreamMap* const me, StreamMapFn fn);
+void StreamFilter_ctor(StreamFilter* const me, StreamPredFn pred);
+void StreamScan_ctor(StreamScan* const me, StreamReduceFn fn, int32_t seed);
+void StreamMerge_ctor(StreamMerge* const me);
+void StreamZip_ctor(StreamZip* const me, StreamReduceFn fn);
+void StreamWindow_ctor(StreamWindow* const me, StreamReduceFn fn, int32_t seed, uint32_t size);
+void StreamSink_ctor(StreamSink* const me, Active* act, Signal sig, SampleEvt* sto, uint16_t len);
+
+#endif /* FREE_ACT_STREAM_H */
@@ -0,0 +1,43 @@
+/*****************************************************************************
+ * FreeAct event trace
+ *
+ * A small RAM ring of post/dispatch records. Every record is stamped from
+ * esp_timer (a single hardware counter read by both cores, so stamps from
+ * core 0 and core 1 share one time base) together with a global sequence
+ * number; both are taken under the trace lock, so sequence order, time
+ * order and the causal post -> dispatch order always agree. The per-core
+ * CPU cycle counters are deliberately not used here: they are not
+ * synchronized between the two cores.
+ *
+ * MIT License, see FreeAct.h
+ *****************************************************************************/
+#ifndef FREE_ACT_TRACE_H
+#define FREE_ACT_TRACE_H
+
+#include "FreeAct.h"
+
+/* trace record types */
+enum
+{
+    TRACE_POST,     /* event posted to 'act' */
+    TRACE_DISPATCH, /* 'act' starts dispatching the event */
+    TRACE_DONE      /* 'act' finished dispatching the event */
+};
+
+/* one trace record */
+typedef struct
+{
+    int64_t       ts;   /* microseconds since boot, common to all cores */
+    uint32_t      seq;  /* global sequence number */
+    Active const* act;  /* the AO */
+    Signal        sig;  /* the event signal */
+    uint8_t       type; /* TRACE_POST, TRACE_DISPATCH or TRACE_DONE */
+    uint8_t       core; /* core that produced the record */
+} TraceRec;
+
+int64_t  FreeAct_time(void); /* the trace time base (us), any core, any context */
+void     FreeAct_trace(uint8_t type, Active const* const act, Signal sig); /* task or ISR */
+uint32_t FreeAct_traceSnapshot(TraceRec* buf, uint32_t maxLen); /* oldest first, task context */
+void     FreeAct_traceDump(void); /* task context; a concurrent second dump is refused */
+
+#endif /* FREE_ACT_TRACE_H */
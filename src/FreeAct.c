@@ -33,81 +33,1478 @@
  *****************************************************************************/
 #include "FreeAct.h" /* Free Active Object interface */
 
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#if CONFIG_FREEACT_TRACE
+#include "FreeAct_trace.h"
+#endif
+
 #include "freertos/FreeRTOS.h"
 #include "freertos/FreeRTOSConfig.h"
+#include "freertos/event_groups.h"
 #include "freertos/queue.h"
 #include "freertos/task.h"
 #include "freertos/timers.h"
 
+#define TAG "FreeAct"
+
+#if CONFIG_FREEACT_CURRENT && (CONFIG_FREEACT_CURRENT_TLS_INDEX >= configNUM_THREAD_LOCAL_STORAGE_POINTERS)
+#error "raise CONFIG_FREERTOS_THREAD_LOCAL_STORAGE_POINTERS above CONFIG_FREEACT_CURRENT_TLS_INDEX"
+#endif
+
+/*..........................................................................*/
+void Active_ctor(Active* const me, DispatchHandler dispatch)
+{
+    me->dispatch = dispatch; /* assign the dispatch handler */
+    me->prio     = 0U;
+#if CONFIG_FREEACT_COPY_EVENTS
+    me->copySize = 0U;
+#endif
+#if CONFIG_FREEACT_DISPATCH_GEN
+    me->gen = 0U;
+#endif
+#if CONFIG_FREEACT_CURRENT
+    me->curEvt = (Event const*)0;
+#endif
+#if CONFIG_FREEACT_STARVATION
+    me->starveGen      = 0U;
+    me->waitGen        = 0U;
+    me->waitSince      = 0U;
+    me->waiting        = false;
+    me->starveActive   = false;
+    me->starveReported = false;
+#endif
+#if CONFIG_FREEACT_BLOCK_CHECK
+    me->blk.obj       = (void const*)0;
+    me->blk.kind      = 0U;
+    me->blk.count     = 0U;
+    me->blk.blockedUs = 0U;
+    me->blkSince      = 0;
+    me->blkExempt     = false;
+#endif
+#if CONFIG_FREEACT_ELASTIC_QUEUE
+    me->ovfSto   = (Event const**)0;
+    me->ovfLen   = 0U;
+    me->ovfHead  = 0U;
+    me->ovfCount = 0U;
+    me->ovfPeak  = 0U;
+    portMUX_INITIALIZE(&me->ovfLock);
+#endif
+#if CONFIG_FREEACT_PRIO_INHERIT
+    me->effPrio   = 0U;
+    me->nRequests = 0U;
+#endif
+#if CONFIG_FREEACT_LAZY_AO
+    me->lazyState = LAZY_OFF;
+    me->initDone  = false;
+    portMUX_INITIALIZE(&me->lazyLock);
+#endif
+#if CONFIG_FREEACT_BOOT_BARRIER
+    me->bootNext = (Active*)0;
+    me->initUs   = 0U;
+    me->initCore = -1;
+    me->bootWait = false;
+#endif
+#if CONFIG_FREEACT_COOP_SCHED
+    me->sched     = (ActiveSched*)0;
+    me->schedNext = (Active*)0;
+#endif
+#if CONFIG_FREEACT_SPAWN
+    me->pool        = (ActivePool*)0;
+    me->initPending = false;
+#endif
+}
+
+#if CONFIG_FREEACT_CURRENT && CONFIG_IDF_TARGET_LINUX
+/* On the host, tasks are pthreads, but so are the port's own threads and
+ * libc helpers, which see the thread-local storage of whichever task is
+ * current: the AO this very pthread dispatches tells them apart.
+ */
+static __thread Active* l_hostAo;
+#endif
+
+/*..........................................................................*/
+/* dispatch one event, keeping the dispatch generation up to date */
+static inline void Active_dispatch(Active* const me, Event const* const e)
+{
+#if CONFIG_FREEACT_WATCHDOG
+    me->curSig = e->sig;
+#endif
+#if CONFIG_FREEACT_CURRENT
+    me->curEvt = e;
+    vTaskSetThreadLocalStoragePointer((TaskHandle_t)0, CONFIG_FREEACT_CURRENT_TLS_INDEX, me);
+#if CONFIG_IDF_TARGET_LINUX
+    l_hostAo = me;
+#endif
+#endif
+#if CONFIG_FREEACT_DISPATCH_GEN
+    ++me->gen; /* odd: inside dispatch */
+#endif
+#if CONFIG_FREEACT_TRACE
+    FreeAct_trace(TRACE_DISPATCH, me, e->sig);
+#endif
+
+    (*me->dispatch)(me, e); /* NO BLOCKING! */
+
+#if CONFIG_FREEACT_TRACE
+    FreeAct_trace(TRACE_DONE, me, e->sig);
+#endif
+#if CONFIG_FREEACT_DISPATCH_GEN
+    ++me->gen; /* even: back to idle */
+#endif
+#if CONFIG_FREEACT_CURRENT
+    vTaskSetThreadLocalStoragePointer((TaskHandle_t)0, CONFIG_FREEACT_CURRENT_TLS_INDEX, (void*)0);
+    me->curEvt = (Event const*)0;
+#if CONFIG_IDF_TARGET_LINUX
+    l_hostAo = (Active*)0;
+#endif
+#endif
+#if CONFIG_FREEACT_BLOCK_CHECK
+    if (me->blk.count != 0U)
+    {
+        /* reported outside the dispatch, so the report itself may block */
+        FreeAct_onDispatchBlock(me, e->sig, &me->blk);
+        me->blk.count     = 0U;
+        me->blk.blockedUs = 0U;
+    }
+#endif
+}
+
+#if CONFIG_FREEACT_ELASTIC_QUEUE
+/*..........................................................................*/
+/* post through the overflow ring: while it holds anything, new events queue
+ * up behind it so that the posting order is preserved
+ */
+static void Active_postElastic(Active* const me, Event const* const e, BaseType_t* pxHigherPriorityTaskWoken)
+{
+    portENTER_CRITICAL_SAFE(&me->ovfLock);
+    if ((me->ovfCount != 0U) || (xQueueSendToBackFromISR(me->queue, (void*)&e, pxHigherPriorityTaskWoken) != pdTRUE))
+    {
+        configASSERT(me->ovfCount < me->ovfLen); /* overflow ring must not overflow */
+        me->ovfSto[(me->ovfHead + me->ovfCount) % me->ovfLen] = e;
+        ++me->ovfCount;
+        if (me->ovfCount > me->ovfPeak)
+        {
+            me->ovfPeak = me->ovfCount;
+        }
+    }
+    portEXIT_CRITICAL_SAFE(&me->ovfLock);
+}
+
+/*..........................................................................*/
+/* Refill the queue from the overflow ring (called by the AO itself).
+ * 'ovfCount' is read under the lock only: a poster on the other core may
+ * be between its failed send and the increment, and a drain that missed
+ * it would leave every later post stranded in the ring.
+ */
+static void Active_drainOverflow(Active* const me)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE; /* the only receiver is 'me' */
+
+    portENTER_CRITICAL(&me->ovfLock);
+    while ((me->ovfCount != 0U) &&
+           (xQueueSendToBackFromISR(me->queue, (void*)&me->ovfSto[me->ovfHead], &xHigherPriorityTaskWoken) == pdTRUE))
+    {
+        me->ovfHead = (me->ovfHead + 1U) % me->ovfLen;
+        --me->ovfCount;
+    }
+    portEXIT_CRITICAL(&me->ovfLock);
+}
+
+/*..........................................................................*/
+void Active_setOverflow(Active* const me, Event const** ovfSto, uint32_t ovfLen)
+{
+    configASSERT((ovfSto != (Event const**)0) && (ovfLen > 0U) && (ovfLen <= UINT16_MAX));
+#if CONFIG_FREEACT_COOP_SCHED
+    configASSERT(me->sched == (ActiveSched*)0); /* private queues only */
+#endif
+#if CONFIG_FREEACT_LAZY_AO
+    configASSERT(me->lazyState == LAZY_OFF); /* lazy AOs are not elastic */
+#endif
+#if CONFIG_FREEACT_COPY_EVENTS
+    configASSERT(me->copySize == 0U); /* the ring holds event pointers */
+#endif
+
+    me->ovfHead  = 0U;
+    me->ovfCount = 0U;
+    me->ovfPeak  = 0U;
+    me->ovfLen   = (uint16_t)ovfLen;
+    me->ovfSto   = ovfSto;
+}
+
+/*..........................................................................*/
+uint16_t Active_overflowPeak(Active const* const me)
+{
+    return me->ovfPeak;
+}
+#endif /* CONFIG_FREEACT_ELASTIC_QUEUE */
+
+#if CONFIG_FREEACT_REGISTRY
+/*--------------------------------------------------------------------------*/
+/* Framework registry of all started AOs... */
+static Active* volatile l_registry; /* most recently started AO first */
+static portMUX_TYPE     l_registryLock = portMUX_INITIALIZER_UNLOCKED;
+
+/*..........................................................................*/
+/* AOs are only ever added, so readers may walk the list without locking */
+static void Active_register(Active* const me)
+{
+    portENTER_CRITICAL(&l_registryLock);
+    me->regNext = l_registry;
+    l_registry  = me;
+    portEXIT_CRITICAL(&l_registryLock);
+}
+#endif /* CONFIG_FREEACT_REGISTRY */
+
+#if CONFIG_FREEACT_CURRENT
+/*..........................................................................*/
+/* O(1): every task holds the AO it dispatches in its thread-local storage,
+ * so the lookup follows the task wherever it runs (no stale AO thread
+ * handles, e.g. of hibernated lazy AOs, and any number of AOs)
+ */
+Active* Active_currentOf(TaskHandle_t task, Event const** e)
+{
+    Active* const a = (Active*)pvTaskGetThreadLocalStoragePointer(task, CONFIG_FREEACT_CURRENT_TLS_INDEX);
+    Event const*  cur;
+
+    if (a == (Active*)0)
+    {
+        return a;
+    }
+#if CONFIG_IDF_TARGET_LINUX
+    if ((task == (TaskHandle_t)0) && (a != l_hostAo))
+    {
+        return (Active*)0; /* called from a pthread that is not this task */
+    }
+#endif
+    cur = a->curEvt;
+    if (cur == (Event const*)0)
+    {
+        return (Active*)0; /* just finishing its dispatch */
+    }
+    *e = cur;
+    return a;
+}
+#endif
+
+#if CONFIG_FREEACT_WATCHDOG
+/*--------------------------------------------------------------------------*/
+/* Watchdog... */
+static StaticTimer_t l_watchdog_cb; /* timer control-block (FreeRTOS static alloc) */
+
+/*..........................................................................*/
+/* a dispatch still in progress with the generation of the last check has
+ * been running for at least one full period
+ */
+static void FreeAct_watchdogCallback(TimerHandle_t xTimer)
+{
+    Active* a;
+
+    (void)xTimer;
+    for (a = l_registry; a != (Active*)0; a = a->regNext)
+    {
+        uint32_t const gen = a->gen;
+
+        if (((gen & 1U) != 0U) && (gen == a->wdGen))
+        {
+            FreeAct_onWatchdog(a, a->curSig);
+        }
+        a->wdGen = gen;
+    }
+}
+
+/*..........................................................................*/
+void FreeAct_watchdogStart(uint32_t periodMs)
+{
+    TimerHandle_t timer;
+    BaseType_t    status;
+
+    timer = xTimerCreateStatic("WD", TimeEvent_msToTicks(periodMs), pdTRUE, (void*)0, &FreeAct_watchdogCallback,
+                               &l_watchdog_cb);
+    configASSERT(timer); /* timer must be created */
+
+    status = xTimerStart(timer, 0);
+    configASSERT(status == pdPASS);
+}
+#endif /* CONFIG_FREEACT_WATCHDOG */
+
+#if CONFIG_FREEACT_STARVATION
+/*--------------------------------------------------------------------------*/
+/* Starvation and priority inversion detector... */
+static StaticTimer_t l_starvation_cb; /* timer control-block (FreeRTOS static alloc) */
+static uint16_t      l_starvationPeriods;
+static TickType_t    l_starvationTicks; /* the check period */
+
+/*..........................................................................*/
+/* the FreeRTOS priority the AO's events are dispatched at: AOs on an
+ * ActiveSched run at the scheduler thread's, and boosts are included
+ */
+static UBaseType_t Active_threadPrio(Active const* const me)
+{
+#if CONFIG_FREEACT_LAZY_AO
+    if (me->lazyState == LAZY_DORMANT)
+    {
+        return me->prio + tskIDLE_PRIORITY; /* no thread right now */
+    }
+#endif
+    return (me->thread != (TaskHandle_t)0) ? uxTaskPriorityGet(me->thread) : (me->prio + tskIDLE_PRIORITY);
+}
+
+/*..........................................................................*/
+/* events in the AO's queue (and overflow ring), not yet dispatched */
+static uint32_t Active_pending(Active const* const me)
+{
+    uint32_t n = (me->queue != (QueueHandle_t)0) ? uxQueueMessagesWaiting(me->queue) : 0U;
+
+#if CONFIG_FREEACT_ELASTIC_QUEUE
+    n += me->ovfCount;
+#endif
+    return n;
+}
+
+/*..........................................................................*/
+/* Queues are FIFO, so the events queued at a check are all dispatched once
+ * the generation has advanced past them and the one in progress: until
+ * then, the oldest pending event is at least as old as that check.
+ */
+static void FreeAct_starvationCallback(TimerHandle_t xTimer)
+{
+    TickType_t const now = xTaskGetTickCount();
+    Active*          a;
+
+    (void)xTimer;
+
+    /* pass 1: who made progress since the last check */
+    for (a = l_registry; a != (Active*)0; a = a->regNext)
+    {
+        uint32_t const gen = a->gen;
+
+        a->starveActive = (gen != a->starveGen) || ((gen & 1U) != 0U);
+        a->starveGen    = gen;
+    }
+
+    /* pass 2: how long the oldest queued event has been waiting */
+    for (a = l_registry; a != (Active*)0; a = a->regNext)
+    {
+        uint32_t const gen     = a->starveGen;
+        uint32_t const pending = Active_pending(a);
+        uint32_t const doneGen = (gen & ~1U) + (2U * (pending + (gen & 1U))); /* all queued now dispatched */
+
+        if (pending == 0U)
+        {
+            /* episode over, even if the generation fell short of the mark:
+             * one dispatch may take several queued events (BusMgr), and a
+             * queue reset (Active_spawn(), Active_destroy()) discards them
+             */
+            a->waiting        = false;
+            a->starveReported = false;
+            continue;
+        }
+        if (a->waiting && ((int32_t)(doneGen - a->waitGen) < 0))
+        {
+            a->waitGen = doneGen; /* the marked events left are among those queued now */
+        }
+        if (a->waiting && ((int32_t)(gen - a->waitGen) < 0))
+        {
+            uint32_t const periods = (uint32_t)(now - a->waitSince) / l_starvationTicks;
+
+            if (!a->starveReported && (periods >= l_starvationPeriods))
+            {
+                UBaseType_t const prio        = Active_threadPrio(a);
+                Active*           culprit     = (Active*)0;
+                UBaseType_t       culpritPrio = 0U;
+                Active*           b;
+
+                for (b = l_registry; b != (Active*)0; b = b->regNext)
+                {
+                    UBaseType_t bPrio;
+
+                    if (!b->starveActive || (b->thread == a->thread))
+                    {
+                        continue; /* idle, or sharing the victim's thread */
+                    }
+                    bPrio = Active_threadPrio(b);
+                    if ((bPrio < prio) && ((culprit == (Active*)0) || (bPrio > culpritPrio)))
+                    {
+                        culprit     = b;
+                        culpritPrio = bPrio;
+                    }
+                }
+                a->starveReported = true;
+                FreeAct_onStarvation(a, culprit, (periods > UINT16_MAX) ? UINT16_MAX : (uint16_t)periods);
+            }
+            continue;
+        }
+
+        /* everything queued at the last mark is done: mark the current backlog */
+        a->waiting   = true;
+        a->waitGen   = doneGen;
+        a->waitSince = now;
+    }
+}
+
+/*..........................................................................*/
+void FreeAct_starvationStart(uint32_t periodMs, uint16_t nPeriods)
+{
+    TimerHandle_t timer;
+    BaseType_t    status;
+
+    configASSERT(nPeriods > 0U);
+    l_starvationPeriods = nPeriods;
+    l_starvationTicks   = TimeEvent_msToTicks(periodMs);
+    timer = xTimerCreateStatic("STV", l_starvationTicks, pdTRUE, (void*)0, &FreeAct_starvationCallback,
+                               &l_starvation_cb);
+    configASSERT(timer); /* timer must be created */
+
+    status = xTimerStart(timer, 0);
+    configASSERT(status == pdPASS);
+}
+#endif /* CONFIG_FREEACT_STARVATION */
+
+/*..........................................................................*/
+static Event const l_initEvt = {INIT_SIG}; /* dispatched before the event-loop */
+
+#if CONFIG_FREEACT_BOOT_BARRIER
+/*--------------------------------------------------------------------------*/
+/* Startup barrier... */
+#define BOOT_GO_BIT      (1U << 0) /* AOs may dispatch INIT_SIG */
+#define BOOT_RELEASE_BIT (1U << 1) /* all INIT_SIGs done, enter event loops */
+
+static StaticEventGroup_t l_boot_cb;     /* event group control block */
+static EventGroupHandle_t l_boot;        /* barrier bits */
+static Active*            l_bootList;    /* AOs started before the boot */
+static uint32_t           l_bootPending; /* INIT_SIGs still running */
+static bool volatile      l_booted;      /* FreeAct_boot() was called */
+static int64_t            l_bootStartUs; /* time of FreeAct_boot() */
+static int64_t            l_bootEndUs;   /* time of the release */
+static portMUX_TYPE       l_bootLock = portMUX_INITIALIZER_UNLOCKED; /* guards l_bootPending */
+
+/*..........................................................................*/
+/* register an AO started before FreeAct_boot() */
+static void Active_bootRegister(Active* const me)
+{
+    /* no critical section because it is presumed that the AOs are started
+     * from a single task before FreeAct_boot().
+     */
+    if (l_booted)
+    {
+        return; /* too late for the barrier, initialize right away */
+    }
+    if (l_boot == (EventGroupHandle_t)0)
+    {
+        l_boot = xEventGroupCreateStatic(&l_boot_cb);
+        configASSERT(l_boot);
+    }
+    me->bootNext = l_bootList;
+    me->bootWait = true;
+    l_bootList   = me;
+    ++l_bootPending;
+}
+
+/*..........................................................................*/
+/* INIT_SIG of a registered AO: wait for the go, initialize, then wait
+ * for the release of all AOs
+ */
+static void Active_bootInit(Active* const me)
+{
+    int64_t t0;
+    bool    last;
+
+    (void)xEventGroupWaitBits(l_boot, BOOT_GO_BIT, pdFALSE, pdTRUE, portMAX_DELAY);
+
+    t0 = esp_timer_get_time();
+    Active_dispatch(me, &l_initEvt);
+    me->initUs   = (uint32_t)(esp_timer_get_time() - t0);
+    me->initCore = (int8_t)xPortGetCoreID();
+
+    portENTER_CRITICAL(&l_bootLock);
+    last = (--l_bootPending == 0U);
+    portEXIT_CRITICAL(&l_bootLock);
+
+    if (last)
+    {
+        l_bootEndUs = esp_timer_get_time();
+        (void)xEventGroupSetBits(l_boot, BOOT_RELEASE_BIT);
+    }
+    (void)xEventGroupWaitBits(l_boot, BOOT_RELEASE_BIT, pdFALSE, pdTRUE, portMAX_DELAY);
+}
+
+/*..........................................................................*/
+void FreeAct_boot(void)
+{
+    l_booted      = true;
+    l_bootStartUs = esp_timer_get_time();
+
+    if (l_bootList == (Active*)0)
+    {
+        l_bootEndUs = l_bootStartUs;
+        return; /* nothing was started before the boot */
+    }
+
+    (void)xEventGroupSetBits(l_boot, BOOT_GO_BIT);
+    (void)xEventGroupWaitBits(l_boot, BOOT_RELEASE_BIT, pdFALSE, pdTRUE, portMAX_DELAY);
+}
+
+/*..........................................................................*/
+void FreeAct_bootReport(void)
+{
+    Active* a;
+
+    ESP_LOGI(TAG, "boot: %lu us", (unsigned long)(l_bootEndUs - l_bootStartUs));
+    for (a = l_bootList; a != (Active*)0; a = a->bootNext)
+    {
+        ESP_LOGI(TAG, "  AO %p prio=%u core=%d init=%lu us", (void*)a,
+                 (unsigned)(uxTaskPriorityGet(a->thread) - tskIDLE_PRIORITY), (int)a->initCore,
+                 (unsigned long)a->initUs);
+    }
+}
+#endif /* CONFIG_FREEACT_BOOT_BARRIER */
+
+#if CONFIG_FREEACT_LAZY_AO
+/*--------------------------------------------------------------------------*/
+/* Lazy activation... */
+static void Active_eventLoop(void* pvParameters);
+
+/*..........................................................................*/
+/* called after every post to a lazy AO: allocate its thread if dormant. The
+ * state is read under 'lazyLock', which Active_hibernate() holds while it
+ * checks the queue and goes dormant, so a post either keeps the thread
+ * alive or sees the AO dormant and wakes it.
+ */
+static void Active_wake(Active* const me)
+{
+    bool       create;
+    BaseType_t status;
+
+    portENTER_CRITICAL(&me->lazyLock);
+    create = (me->lazyState == LAZY_DORMANT);
+    if (create)
+    {
+        me->lazyState = LAZY_RUNNING;
+    }
+    portEXIT_CRITICAL(&me->lazyLock);
+
+    if (create)
+    {
+#if CONFIG_FREEACT_PRIO_INHERIT
+        uint8_t const prio = me->effPrio; /* may be boosted while dormant */
+#else
+        uint8_t const prio = me->prio;
+#endif
+        status = xTaskCreate(&Active_eventLoop,                   /* the thread function */
+                             "AO",                                /* the name of the task */
+                             me->stackSize / sizeof(StackType_t), /* stack depth */
+                             me,                                  /* the 'pvParameters' parameter */
+                             prio + tskIDLE_PRIORITY,             /* FreeRTOS priority */
+                             &me->thread);                        /* task handle */
+        configASSERT(status == pdPASS);                           /* thread must be created */
+    }
+}
+
+/*..........................................................................*/
+/* ISRs cannot create threads: activation is deferred to the timer task */
+static void Active_wakePended(void* pvParameter1, uint32_t ulParameter2)
+{
+    (void)ulParameter2;
+    Active_wake((Active*)pvParameter1);
+}
+
+/*..........................................................................*/
+/* Active_wake() for ISRs: pend the activation only if the AO is dormant */
+static void Active_wakeFromISR(Active* const me, BaseType_t* pxHigherPriorityTaskWoken)
+{
+    bool       dormant;
+    BaseType_t status;
+
+    portENTER_CRITICAL_ISR(&me->lazyLock);
+    dormant = (me->lazyState == LAZY_DORMANT);
+    portEXIT_CRITICAL_ISR(&me->lazyLock);
+
+    if (dormant)
+    {
+        status = xTimerPendFunctionCallFromISR(&Active_wakePended, me, 0U, pxHigherPriorityTaskWoken);
+        configASSERT(status == pdPASS);
+    }
+}
+
+/*..........................................................................*/
+/* called by the AO itself after 'idleMs' without events; checking the
+ * queue and going dormant is one step for the posters (see Active_wake())
+ */
+static void Active_hibernate(Active* const me)
+{
+    portENTER_CRITICAL(&me->lazyLock);
+    if (uxQueueMessagesWaiting(me->queue) != 0U)
+    {
+        portEXIT_CRITICAL(&me->lazyLock);
+        return; /* an event slipped in, keep running */
+    }
+    me->lazyState = LAZY_DORMANT;
+    me->thread    = (TaskHandle_t)0;
+    portEXIT_CRITICAL(&me->lazyLock);
+
+    vTaskDelete((TaskHandle_t)0); /* the idle task frees the stack */
+}
+
+/*..........................................................................*/
+void Active_startLazy(Active* const me, uint8_t prio, /* priority (1-based) */
+                      Event** queueSto, uint32_t queueLen, uint32_t stackSize, uint32_t idleMs)
+{
+#if CONFIG_FREEACT_ELASTIC_QUEUE
+    configASSERT(me->ovfSto == (Event const**)0); /* lazy AOs are not elastic */
+#endif
+
+    me->queue = xQueueCreateStatic(queueLen,           /* queue length - provided by user */
+                                   sizeof(Event*),     /* item size */
+                                   (uint8_t*)queueSto, /* queue storage - provided by user */
+                                   &me->queue_cb);     /* queue control block */
+    configASSERT(me->queue);                           /* queue must be created */
+
+    me->prio      = prio;
+#if CONFIG_FREEACT_PRIO_INHERIT
+    me->effPrio = prio;
+#endif
+    me->stackSize = stackSize;
+    me->idleMs    = idleMs;
+    me->thread    = (TaskHandle_t)0;
+    me->lazyState = LAZY_DORMANT; /* no thread until the first event */
+#if CONFIG_FREEACT_REGISTRY
+    Active_register(me);
+#endif
+}
+#endif /* CONFIG_FREEACT_LAZY_AO */
+
+/*..........................................................................*/
+/* thread function for all Active Objects (FreeRTOS task signature) */
+static void Active_eventLoop(void* pvParameters)
+{
+    Active* me = (Active*)pvParameters;
+
+    TickType_t wait = portMAX_DELAY;
+
+    configASSERT(me); /* Active object must be provided */
+
+    /* initialize the AO */
+#if CONFIG_FREEACT_LAZY_AO
+    if (me->lazyState != LAZY_OFF)
+    {
+        if (me->idleMs != 0U)
+        {
+            wait = pdMS_TO_TICKS(me->idleMs); /* hibernate when idle */
+        }
+        if (!me->initDone)
+        {
+            me->initDone = true;
+            Active_dispatch(me, &l_initEvt); /* first activation only */
+        }
+    }
+    else
+#endif
+#if CONFIG_FREEACT_BOOT_BARRIER
+    if (me->bootWait)
+    {
+        Active_bootInit(me); /* started before FreeAct_boot() */
+    }
+    else
+#endif
+    {
+        Active_dispatch(me, &l_initEvt);
+    }
+
+    for (;;)
+    {                   /* for-ever "superloop" */
+        Event const* e; /* pointer to event object ("message") */
+        void*        item = &e;
+#if CONFIG_FREEACT_COPY_EVENTS
+        union
+        {
+            Event    evt;
+            uint64_t align;
+            uint8_t  bytes[CONFIG_FREEACT_COPY_MAX];
+        } copy; /* the event itself, for copy-in queues */
+
+        if (me->copySize != 0U)
+        {
+            item = &copy;
+            e    = &copy.evt;
+        }
+#endif
+
+        /* wait for any event and receive it into object 'e' */
+        if (xQueueReceive(me->queue, item, wait) != pdTRUE) /* BLOCKING! */
+        {
+#if CONFIG_FREEACT_ELASTIC_QUEUE
+            Active_drainOverflow(me); /* nothing may be left behind in the ring */
+#endif
+#if CONFIG_FREEACT_LAZY_AO
+            Active_hibernate(me); /* returns only if an event arrived */
+#endif
+            continue;
+        }
+        configASSERT(e != (Event const*)0);
+
+#if CONFIG_FREEACT_ELASTIC_QUEUE
+        Active_drainOverflow(me); /* a slot just became free */
+#endif
+
+        /* dispatch event to the active object 'me' */
+        Active_dispatch(me, e); /* NO BLOCKING! */
+    }
+}
+
+/*..........................................................................*/
+void Active_start(Active* const me, uint8_t prio, /* priority (1-based) */
+                  Event** queueSto, uint32_t queueLen, void* stackSto, uint32_t stackSize, uint16_t opt)
+{
+    StackType_t* stk_sto   = stackSto;
+    uint32_t     stk_depth = (stackSize / sizeof(StackType_t));
+    uint32_t     itemSize  = sizeof(Event*);
+
+#if CONFIG_FREEACT_COPY_EVENTS
+    if (opt != 0U)
+    {
+        /* 'opt' is the item size of a copy-in queue */
+        configASSERT((opt >= sizeof(Event)) && (opt <= CONFIG_FREEACT_COPY_MAX));
+#if CONFIG_FREEACT_ELASTIC_QUEUE
+        configASSERT(me->ovfSto == (Event const**)0); /* the overflow ring holds pointers */
+#endif
+        me->copySize = (uint8_t)opt;
+        itemSize     = opt;
+    }
+#else
+    (void)opt; /* unused parameter */
+#endif
+    me->prio = prio;
+#if CONFIG_FREEACT_PRIO_INHERIT
+    me->effPrio = prio;
+#endif
+#if CONFIG_FREEACT_REGISTRY
+    Active_register(me);
+#endif
+#if CONFIG_FREEACT_BOOT_BARRIER
+    Active_bootRegister(me); /* before the thread can run */
+#endif
+    me->queue = xQueueCreateStatic(queueLen,           /* queue length - provided by user */
+                                   itemSize,           /* item size */
+                                   (uint8_t*)queueSto, /* queue storage - provided by user */
+                                   &me->queue_cb);     /* queue control block */
+    configASSERT(me->queue);                           /* queue must be created */
+
+    me->thread = xTaskCreateStatic(&Active_eventLoop,       /* the thread function */
+                                   "AO",                    /* the name of the task */
+                                   stk_depth,               /* stack depth */
+                                   me,                      /* the 'pvParameters' parameter */
+                                   prio + tskIDLE_PRIORITY, /* FreeRTOS priority */
+                                   stk_sto,                 /* stack storage - provided by user */
+                                   &me->thread_cb);         /* task control block */
+    configASSERT(me->thread);                               /* thread must be created */
+}
+
+/*..........................................................................*/
+void Active_post(Active* const me, Event const* const e)
+{
+#if CONFIG_FREEACT_COOP_SCHED
+    if (me->sched != (ActiveSched*)0)
+    {
+        Active_postDeadline(me, e, me->deadlineMs);
+        return;
+    }
+#endif
+
+#if CONFIG_FREEACT_COPY_EVENTS
+    configASSERT(me->copySize == 0U); /* would drop the payload: use Active_postCopy() */
+#endif
+
+#if CONFIG_FREEACT_TRACE
+    FreeAct_trace(TRACE_POST, me, e->sig); /* before the send: precedes the dispatch record */
+#endif
+
+#if CONFIG_FREEACT_ELASTIC_QUEUE
+    if (me->ovfSto != (Event const**)0)
+    {
+        BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+        Active_postElastic(me, e, &xHigherPriorityTaskWoken);
+        if (xHigherPriorityTaskWoken)
+        {
+            taskYIELD();
+        }
+        return;
+    }
+#endif
+
+    BaseType_t status = xQueueSendToBack(me->queue, (void*)&e, (TickType_t)0);
+    configASSERT(status == pdTRUE);
+
+#if CONFIG_FREEACT_LAZY_AO
+    if (me->lazyState != LAZY_OFF) /* never changes for a regular AO */
+    {
+        Active_wake(me); /* after the send: the AO may be hibernating right now */
+    }
+#endif
+}
+
+/*..........................................................................*/
+void Active_postFromISR(Active* const me, Event const* const e, BaseType_t* pxHigherPriorityTaskWoken)
+{
+#if CONFIG_FREEACT_COOP_SCHED
+    if (me->sched != (ActiveSched*)0)
+    {
+        Active_postDeadlineFromISR(me, e, me->deadlineMs, pxHigherPriorityTaskWoken);
+        return;
+    }
+#endif
+
+#if CONFIG_FREEACT_COPY_EVENTS
+    configASSERT(me->copySize == 0U); /* would drop the payload: use Active_postCopyFromISR() */
+#endif
+
+#if CONFIG_FREEACT_TRACE
+    FreeAct_trace(TRACE_POST, me, e->sig);
+#endif
+
+#if CONFIG_FREEACT_ELASTIC_QUEUE
+    if (me->ovfSto != (Event const**)0)
+    {
+        Active_postElastic(me, e, pxHigherPriorityTaskWoken);
+        return;
+    }
+#endif
+
+    BaseType_t status = xQueueSendToBackFromISR(me->queue, (void*)&e, pxHigherPriorityTaskWoken);
+    configASSERT(status == pdTRUE);
+
+#if CONFIG_FREEACT_LAZY_AO
+    if (me->lazyState != LAZY_OFF) /* never changes for a regular AO */
+    {
+        Active_wakeFromISR(me, pxHigherPriorityTaskWoken);
+    }
+#endif
+}
+
+/*..........................................................................*/
+/* Posts at most one event until the AO consumes it; everything the ISR
+ * reports in the meantime is folded into the pending event's accumulator.
+ */
+void Active_postFromISR_coalesced(Active* const me, CoalescedEvent* const e, uint32_t count, uint32_t flags,
+                                  BaseType_t* pxHigherPriorityTaskWoken)
+{
+    bool post;
+
+#if CONFIG_FREEACT_COPY_EVENTS
+    configASSERT(me->copySize == 0U); /* the consumer must see the original */
+#endif
+    portENTER_CRITICAL_ISR(&e->lock);
+    e->count += count;
+    e->flags |= flags;
+    post       = !e->pending;
+    e->pending = true;
+    portEXIT_CRITICAL_ISR(&e->lock);
+
+    if (post)
+    {
+        Active_postFromISR(me, &e->super, pxHigherPriorityTaskWoken);
+    }
+}
+
+#if CONFIG_FREEACT_COPY_EVENTS
+/*..........................................................................*/
+/* the queue item of a copy-in queue: the event's first 'size' bytes */
+static void Active_copyIn(Active const* const me, Event const* const e, uint16_t size, void* item)
+{
+    configASSERT((me->copySize != 0U) && (size >= sizeof(Event)) && (size <= me->copySize));
+    memcpy(item, e, size);
+    memset((uint8_t*)item + size, 0, me->copySize - size);
+}
+
+/*..........................................................................*/
+void Active_postCopy(Active* const me, Event const* const e, uint16_t size)
+{
+    uint64_t   item[(CONFIG_FREEACT_COPY_MAX + 7) / 8]; /* aligned for any event */
+    BaseType_t status;
+
+#if CONFIG_FREEACT_TRACE
+    FreeAct_trace(TRACE_POST, me, e->sig);
+#endif
+    Active_copyIn(me, e, size, item);
+    status = xQueueSendToBack(me->queue, item, (TickType_t)0);
+    configASSERT(status == pdTRUE);
+}
+
+/*..........................................................................*/
+void Active_postCopyFromISR(Active* const me, Event const* const e, uint16_t size,
+                            BaseType_t* pxHigherPriorityTaskWoken)
+{
+    uint64_t   item[(CONFIG_FREEACT_COPY_MAX + 7) / 8]; /* aligned for any event */
+    BaseType_t status;
+
+#if CONFIG_FREEACT_TRACE
+    FreeAct_trace(TRACE_POST, me, e->sig);
+#endif
+    Active_copyIn(me, e, size, item);
+    status = xQueueSendToBackFromISR(me->queue, item, pxHigherPriorityTaskWoken);
+    configASSERT(status == pdTRUE);
+}
+#endif /* CONFIG_FREEACT_COPY_EVENTS */
+
+#if CONFIG_FREEACT_PRIO_INHERIT
+/*--------------------------------------------------------------------------*/
+/* Priority inheritance services... */
+static portMUX_TYPE l_piLock = portMUX_INITIALIZER_UNLOCKED; /* guards effPrio/nRequests */
+
+/*..........................................................................*/
+static uint8_t Active_piPrio(Active const* const me)
+{
+    uint8_t prio;
+
+    portENTER_CRITICAL(&l_piLock);
+    prio = me->effPrio;
+    portEXIT_CRITICAL(&l_piLock);
+    return prio;
+}
+
+/*..........................................................................*/
+/* Apply the effective priority to the AO's private thread. Boosts and
+ * restores may race on the two cores, and vTaskPrioritySet() cannot run
+ * under l_piLock: every caller re-reads 'effPrio' after setting it and
+ * repeats until they agree, so the last one to apply leaves the current
+ * value.
+ */
+static void Active_applyPrio(Active* const me)
+{
+    uint8_t prio = Active_piPrio(me);
+    uint8_t applied;
+
+#if CONFIG_FREEACT_COOP_SCHED
+    if (me->sched != (ActiveSched*)0)
+    {
+        return; /* a shared thread is not the AO's to boost */
+    }
+#endif
+    do
+    {
+        applied = prio;
+        if (me->thread != (TaskHandle_t)0)
+        {
+            vTaskPrioritySet(me->thread, applied + tskIDLE_PRIORITY);
+        }
+        prio = Active_piPrio(me);
+    } while (prio != applied);
+}
+
+/*..........................................................................*/
+void Active_postRequest(Active* const me, Event const* const e, Active const* const client)
+{
+    bool boost = false;
+
+    portENTER_CRITICAL(&l_piLock);
+    ++me->nRequests;
+    if (client->effPrio > me->effPrio)
+    {
+        me->effPrio = client->effPrio; /* a boosted client passes its boost on */
+        boost       = true;
+    }
+    portEXIT_CRITICAL(&l_piLock);
+
+    if (boost)
+    {
+        Active_applyPrio(me); /* before the server gets the request */
+    }
+    Active_post(me, e);
+}
+
+/*..........................................................................*/
+void Active_reply(Active* const me, Active* const client, Event const* const e)
+{
+    bool restore = false;
+
+    portENTER_CRITICAL(&l_piLock);
+    if (me->nRequests != 0U)
+    {
+        --me->nRequests;
+    }
+    if ((me->nRequests == 0U) && (me->effPrio != me->prio))
+    {
+        me->effPrio = me->prio;
+        restore     = true;
+    }
+    portEXIT_CRITICAL(&l_piLock);
+
+    Active_post(client, e); /* reply while still boosted */
+    if (restore)
+    {
+        Active_applyPrio(me);
+    }
+}
+#endif /* CONFIG_FREEACT_PRIO_INHERIT */
+
+/*--------------------------------------------------------------------------*/
+/* Coalesced Event services... */
+
+/*..........................................................................*/
+void CoalescedEvent_ctor(CoalescedEvent* const me, Signal sig)
+{
+    me->super.sig = sig;
+    portMUX_INITIALIZE(&me->lock);
+    me->count   = 0U;
+    me->flags   = 0U;
+    me->pending = false;
+}
+
+/*..........................................................................*/
+/* called by the AO when it handles the event: takes the accumulated
+ * payload and re-opens the slot for the next post from the ISR
+ */
+void CoalescedEvent_consume(CoalescedEvent const* const me, uint32_t* count, uint32_t* flags)
+{
+    CoalescedEvent* const slot = (CoalescedEvent*)me; /* the event is const only to the AO */
+
+    portENTER_CRITICAL(&slot->lock);
+    if (count != (uint32_t*)0)
+    {
+        *count = slot->count;
+    }
+    if (flags != (uint32_t*)0)
+    {
+        *flags = slot->flags;
+    }
+    slot->count   = 0U;
+    slot->flags   = 0U;
+    slot->pending = false;
+    portEXIT_CRITICAL(&slot->lock);
+}
+
+/*--------------------------------------------------------------------------*/
+/* Cooperative scheduler services... */
+#if CONFIG_FREEACT_COOP_SCHED
+
+/*..........................................................................*/
+void ActiveSched_ctor(ActiveSched* const me, SchedPolicy policy)
+{
+    me->thread      = (TaskHandle_t)0;
+    me->members     = (Active*)0;
+    me->policy      = policy;
+    portMUX_INITIALIZE(&me->lock);
+#if CONFIG_FREEACT_SPAWN
+    me->retired = (Active*)0;
+#endif
+    me->nDispatched = 0U;
+    me->nMissed     = 0U;
+}
+
+/*..........................................................................*/
+/* pick the AO to run next according to the policy, NULL if all are idle */
+static Active* ActiveSched_next(ActiveSched* const me)
+{
+    Active*   best = (Active*)0;
+    SchedItem bestHead;
+    Active*   a;
+
+    for (a = me->members; a != (Active*)0; a = a->schedNext)
+    {
+        SchedItem head;
+        if (xQueuePeek(a->queue, &head, (TickType_t)0) != pdTRUE)
+        {
+            continue; /* nothing pending for this AO */
+        }
+        if (best == (Active*)0)
+        {
+            best     = a;
+            bestHead = head;
+        }
+        else if (me->policy == SCHED_EDF)
+        {
+            /* earliest deadline first, ties broken by the AO priority */
+            if ((head.deadline < bestHead.deadline) || ((head.deadline == bestHead.deadline) && (a->prio > best->prio)))
+            {
+                best     = a;
+                bestHead = head;
+            }
+        }
+        else if (a->prio > best->prio)
+        {
+            best     = a;
+            bestHead = head;
+        }
+    }
+    return best;
+}
+
+#if CONFIG_FREEACT_SPAWN
+static void ActiveSched_recycle(ActiveSched* const me);
+#endif
+
+/*..........................................................................*/
+/* thread function shared by all AOs attached to the scheduler */
+static void ActiveSched_eventLoop(void* pvParameters)
+{
+    ActiveSched* me = (ActiveSched*)pvParameters;
+    Active*      first;
+    Active*      a;
+
+    configASSERT(me); /* scheduler must be provided */
+
+    /* Publish the thread before anything runs on it: this task may start
+     * before xTaskCreateStatic() returns in ActiveSched_start(). AOs linked
+     * from now on get their INIT_SIG posted; the ones before are 'first'.
+     */
+    portENTER_CRITICAL(&me->lock);
+    me->thread = xTaskGetCurrentTaskHandle();
+    first      = me->members;
+    for (a = first; a != (Active*)0; a = a->schedNext)
+    {
+        a->thread = me->thread; /* attached AOs run in the shared thread */
+    }
+    portEXIT_CRITICAL(&me->lock);
+
+    /* initialize the AOs attached before the start */
+#if CONFIG_FREEACT_SPAWN
+    /* any INIT_SIG may destroy AOs, so no link survives a dispatch: go on
+     * from 'a' while it is alive, otherwise rescan for the pending ones
+     */
+    a = first;
+    while (a != (Active*)0)
+    {
+        if (!a->initPending)
+        {
+            a = a->schedNext;
+            continue;
+        }
+        a->initPending = false;
+        Active_dispatch(a, &l_initEvt);
+        ActiveSched_recycle(me);
+        if (a->dispatch == (DispatchHandler)0)
+        {
+            a = me->members; /* 'a' destroyed itself */
+        }
+    }
+#else
+    for (a = first; a != (Active*)0; a = a->schedNext)
+    {
+        Active_dispatch(a, &l_initEvt);
+    }
+#endif
+
+    for (;;)
+    { /* for-ever "superloop" */
+        /* run to completion until all attached queues are drained */
+        while ((a = ActiveSched_next(me)) != (Active*)0)
+        {
+            SchedItem item;
+
+            (void)xQueueReceive(a->queue, &item, (TickType_t)0);
+            configASSERT(item.e != (Event const*)0);
+
+            Active_dispatch(a, item.e); /* NO BLOCKING! */
+#if CONFIG_FREEACT_SPAWN
+            ActiveSched_recycle(me);
+#endif
+
+            ++me->nDispatched;
+            if (esp_timer_get_time() > item.deadline)
+            {
+                ++me->nMissed;
+            }
+        }
+
+        /* wait until any attached AO has something to do */
+        (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY); /* BLOCKING! */
+    }
+}
+
+/*..........................................................................*/
+void ActiveSched_start(ActiveSched* const me, uint8_t prio, /* priority (1-based) */
+                       void* stackSto, uint32_t stackSize)
+{
+    StackType_t* stk_sto   = stackSto;
+    uint32_t     stk_depth = (stackSize / sizeof(StackType_t));
+    TaskHandle_t thread;
+
+    /* 'me->thread' is published by the thread itself, see ActiveSched_eventLoop() */
+    thread = xTaskCreateStatic(&ActiveSched_eventLoop,  /* the thread function */
+                               "AOS",                   /* the name of the task */
+                               stk_depth,               /* stack depth */
+                               me,                      /* the 'pvParameters' parameter */
+                               prio + tskIDLE_PRIORITY, /* FreeRTOS priority */
+                               stk_sto,                 /* stack storage - provided by user */
+                               &me->thread_cb);         /* task control block */
+    configASSERT(thread);                               /* thread must be created */
+    (void)thread;
+}
+
+/*..........................................................................*/
+/* link an AO with an existing queue into the scheduler's member list */
+static void Active_link(Active* const me, ActiveSched* const sched, uint8_t prio, uint32_t deadlineMs)
+{
+    me->prio       = prio;
+    me->deadlineMs = deadlineMs;
+#if CONFIG_FREEACT_PRIO_INHERIT
+    me->effPrio = prio;
+#endif
+    me->sched = sched;
+
+    /* the scheduler walks 'members' without locking: publish at the head;
+     * the lock orders this against the scheduler thread publishing itself
+     */
+    portENTER_CRITICAL(&sched->lock);
+    me->thread     = sched->thread;
+    me->schedNext  = sched->members;
+    sched->members = me;
+#if CONFIG_FREEACT_SPAWN
+    me->initPending = (me->thread == (TaskHandle_t)0); /* initialized when the scheduler starts */
+#endif
+    portEXIT_CRITICAL(&sched->lock);
+
+    if (me->thread != (TaskHandle_t)0)
+    {
+        /* linked to a running scheduler: initialize from its thread */
+        Active_post(me, &l_initEvt);
+    }
+}
+
+/*..........................................................................*/
+void Active_attach(Active* const me, ActiveSched* const sched, uint8_t prio, uint32_t deadlineMs,
+                   SchedItem* queueSto, uint32_t queueLen)
+{
+    me->queue = xQueueCreateStatic(queueLen,           /* queue length - provided by user */
+                                   sizeof(SchedItem),  /* item size */
+                                   (uint8_t*)queueSto, /* queue storage - provided by user */
+                                   &me->queue_cb);     /* queue control block */
+    configASSERT(me->queue);                           /* queue must be created */
+
+#if CONFIG_FREEACT_REGISTRY
+    Active_register(me);
+#endif
+    Active_link(me, sched, prio, deadlineMs);
+}
+
+#if CONFIG_FREEACT_SPAWN
+/*--------------------------------------------------------------------------*/
+/* Dynamic Active Object services... */
+
 /*..........................................................................*/
-void Active_ctor(Active* const me, DispatchHandler dispatch)
+static Active* ActivePool_inst(ActivePool const* const me, uint16_t i)
 {
-    me->dispatch = dispatch; /* assign the dispatch handler */
+    return (Active*)(me->instSto + ((size_t)i * me->instSize));
 }
 
 /*..........................................................................*/
-/* thread function for all Active Objects (FreeRTOS task signature) */
-static void Active_eventLoop(void* pvParameters)
+void ActivePool_ctor(ActivePool* const me, ActiveSched* const sched, uint8_t prio, uint32_t deadlineMs,
+                     void* instSto, uint16_t instSize, uint16_t nInst, SchedItem* queueSto, uint16_t queueLen)
 {
-    Active*            me      = (Active*)pvParameters;
-    static Event const initEvt = {INIT_SIG};
+    uint16_t i;
 
-    configASSERT(me); /* Active object must be provided */
+    configASSERT((instSto != (void*)0) && (instSize >= sizeof(Active)) && (nInst > 0U));
+    configASSERT((queueSto != (SchedItem*)0) && (queueLen > 0U));
 
-    /* initialize the AO */
-    (*me->dispatch)(me, &initEvt);
+    me->sched      = sched;
+    me->instSto    = (uint8_t*)instSto;
+    me->instSize   = instSize;
+    me->nInst      = nInst;
+    me->nUsed      = 0U;
+    me->prio       = prio;
+    me->deadlineMs = deadlineMs;
+    me->timerSto   = (TimeEvent*)0;
+    me->freeList   = (Active*)0;
+    portMUX_INITIALIZE(&me->lock);
 
-    for (;;)
-    {                   /* for-ever "superloop" */
-        Event const* e; /* pointer to event object ("message") */
+    /* queues are created once and reset on every spawn */
+    for (i = nInst; i > 0U; --i)
+    {
+        Active* const a = ActivePool_inst(me, i - 1U);
 
-        /* wait for any event and receive it into object 'e' */
-        xQueueReceive(me->queue, &e, portMAX_DELAY); /* BLOCKING! */
-        configASSERT(e != (Event const*)0);
+        memset(a, 0, instSize);
+        Active_ctor(a, (DispatchHandler)0);
+        a->queue = xQueueCreateStatic(queueLen,                                         /* queue length */
+                                      sizeof(SchedItem),                                /* item size */
+                                      (uint8_t*)&queueSto[(size_t)(i - 1U) * queueLen], /* queue storage */
+                                      &a->queue_cb);                                    /* queue control block */
+        configASSERT(a->queue);                                                         /* queue must be created */
+        a->pool      = me;
+        a->schedNext = me->freeList;
+        me->freeList = a;
+#if CONFIG_FREEACT_REGISTRY
+        Active_register(a); /* once per instance, the registry only grows */
+#endif
+    }
+}
 
-        /* dispatch event to the active object 'me' */
-        (*me->dispatch)(me, e); /* NO BLOCKING! */
+/*..........................................................................*/
+void ActivePool_setTimers(ActivePool* const me, TimeEvent* timerSto, Signal sig)
+{
+    uint16_t i;
+
+    for (i = 0U; i < me->nInst; ++i)
+    {
+        timerSto[i].type = TYPE_ONE_SHOT;
+        TimeEvent_ctor(&timerSto[i], sig, ActivePool_inst(me, i));
     }
+    me->timerSto = timerSto;
 }
 
 /*..........................................................................*/
-void Active_start(Active* const me, uint8_t prio, /* priority (1-based) */
-                  Event** queueSto, uint32_t queueLen, void* stackSto, uint32_t stackSize, uint16_t opt)
+TimeEvent* ActivePool_timer(ActivePool const* const me, Active const* const act)
 {
-    StackType_t* stk_sto   = stackSto;
-    uint32_t     stk_depth = (stackSize / sizeof(StackType_t));
+    configASSERT(me->timerSto != (TimeEvent*)0);
+    return &me->timerSto[((uint8_t const*)act - me->instSto) / me->instSize];
+}
 
-    (void)opt;                                         /* unused parameter */
-    me->queue = xQueueCreateStatic(queueLen,           /* queue length - provided by user */
-                                   sizeof(Event*),     /* item size */
-                                   (uint8_t*)queueSto, /* queue storage - provided by user */
-                                   &me->queue_cb);     /* queue control block */
-    configASSERT(me->queue);                           /* queue must be created */
+/*..........................................................................*/
+Active* Active_spawn(ActivePool* const pool, DispatchHandler dispatch)
+{
+    Active* me;
 
-    me->thread = xTaskCreateStatic(&Active_eventLoop,       /* the thread function */
-                                   "AO",                    /* the name of the task */
-                                   stk_depth,               /* stack depth */
-                                   me,                      /* the 'pvParameters' parameter */
-                                   prio + tskIDLE_PRIORITY, /* FreeRTOS priority */
-                                   stk_sto,                 /* stack storage - provided by user */
-                                   &me->thread_cb);         /* task control block */
-    configASSERT(me->thread);                               /* thread must be created */
+    portENTER_CRITICAL(&pool->lock);
+    me = pool->freeList;
+    if (me != (Active*)0)
+    {
+        pool->freeList = me->schedNext;
+        ++pool->nUsed;
+    }
+    portEXIT_CRITICAL(&pool->lock);
+
+    if (me == (Active*)0)
+    {
+        return me; /* pool exhausted */
+    }
+
+    /* fresh subclass data; the queue may still hold events posted to the
+     * previous incarnation
+     */
+    memset((uint8_t*)me + sizeof(Active), 0, pool->instSize - sizeof(Active));
+    (void)xQueueReset(me->queue);
+    Active_ctor(me, dispatch);
+    me->pool = pool;
+
+    Active_link(me, pool->sched, pool->prio, pool->deadlineMs);
+    return me;
 }
 
 /*..........................................................................*/
-void Active_post(Active* const me, Event const* const e)
+void Active_destroy(Active* const me)
 {
-    BaseType_t status = xQueueSendToBack(me->queue, (void*)&e, (TickType_t)0);
+    ActivePool* const  pool  = me->pool;
+    ActiveSched* const sched = me->sched;
+    Active**           link;
+
+    configASSERT((pool != (ActivePool*)0) && (sched == pool->sched));
+    configASSERT(xTaskGetCurrentTaskHandle() == sched->thread); /* no one else walks 'members' */
+
+    portENTER_CRITICAL(&sched->lock);
+    for (link = &sched->members; *link != (Active*)0; link = &(*link)->schedNext)
+    {
+        if (*link == me)
+        {
+            *link = me->schedNext;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&sched->lock);
+
+    me->dispatch    = (DispatchHandler)0; /* dead: later posts are dropped */
+    me->initPending = false;
+    if (pool->timerSto != (TimeEvent*)0)
+    {
+        TimeEvent_disarm(ActivePool_timer(pool, me));
+    }
+    (void)xQueueReset(me->queue); /* posts racing with the destroy stay harmless until respawn */
+
+    /* possibly still inside its own dispatch: back to the pool afterwards */
+    me->schedNext  = sched->retired;
+    sched->retired = me;
+}
+
+/*..........................................................................*/
+/* return the AOs destroyed during the last dispatch to their pools */
+static void ActiveSched_recycle(ActiveSched* const me)
+{
+    while (me->retired != (Active*)0)
+    {
+        Active* const     a    = me->retired;
+        ActivePool* const pool = a->pool;
+
+        me->retired = a->schedNext;
+
+        portENTER_CRITICAL(&pool->lock);
+        a->schedNext   = pool->freeList;
+        pool->freeList = a;
+        --pool->nUsed;
+        portEXIT_CRITICAL(&pool->lock);
+    }
+}
+#endif /* CONFIG_FREEACT_SPAWN */
+
+/*..........................................................................*/
+void Active_postDeadline(Active* const me, Event const* const e, uint32_t deadlineMs)
+{
+    SchedItem  item;
+    BaseType_t status;
+
+    if (me->sched == (ActiveSched*)0)
+    {
+        Active_post(me, e); /* private thread: deadline is not tracked */
+        return;
+    }
+#if CONFIG_FREEACT_SPAWN
+    if (me->dispatch == (DispatchHandler)0)
+    {
+        return; /* destroyed pooled AO */
+    }
+#endif
+
+#if CONFIG_FREEACT_TRACE
+    FreeAct_trace(TRACE_POST, me, e->sig);
+#endif
+
+    item.e        = e;
+    item.deadline = esp_timer_get_time() + ((int64_t)deadlineMs * 1000);
+    status        = xQueueSendToBack(me->queue, (void*)&item, (TickType_t)0);
     configASSERT(status == pdTRUE);
+
+    if (me->sched->thread != (TaskHandle_t)0)
+    {
+        (void)xTaskNotifyGive(me->sched->thread);
+    }
 }
 
 /*..........................................................................*/
-void Active_postFromISR(Active* const me, Event const* const e, BaseType_t* pxHigherPriorityTaskWoken)
+void Active_postDeadlineFromISR(Active* const me, Event const* const e, uint32_t deadlineMs,
+                                BaseType_t* pxHigherPriorityTaskWoken)
 {
-    BaseType_t status = xQueueSendToBackFromISR(me->queue, (void*)&e, pxHigherPriorityTaskWoken);
+    SchedItem  item;
+    BaseType_t status;
+
+    if (me->sched == (ActiveSched*)0)
+    {
+        Active_postFromISR(me, e, pxHigherPriorityTaskWoken);
+        return;
+    }
+#if CONFIG_FREEACT_SPAWN
+    if (me->dispatch == (DispatchHandler)0)
+    {
+        return; /* destroyed pooled AO */
+    }
+#endif
+
+#if CONFIG_FREEACT_TRACE
+    FreeAct_trace(TRACE_POST, me, e->sig);
+#endif
+
+    item.e        = e;
+    item.deadline = esp_timer_get_time() + ((int64_t)deadlineMs * 1000);
+    status        = xQueueSendToBackFromISR(me->queue, (void*)&item, pxHigherPriorityTaskWoken);
     configASSERT(status == pdTRUE);
+
+    if (me->sched->thread != (TaskHandle_t)0)
+    {
+        vTaskNotifyGiveFromISR(me->sched->thread, pxHigherPriorityTaskWoken);
+    }
 }
 
+#endif /* CONFIG_FREEACT_COOP_SCHED */
+
 /*--------------------------------------------------------------------------*/
 /* Time Event services... */
 static void TimeEvent_callback(TimerHandle_t xTimer);
@@ -120,81 +1517,391 @@ void TimeEvent_ctor(TimeEvent* const me, Signal sig, Active* act)
      */
     me->super.sig = sig;
     me->act       = act;
+#if CONFIG_FREEACT_CALENDAR
+    me->at        = 0;
+    me->cal       = (CalSchedule const*)0;
+    me->calNext   = (TimeEvent*)0;
+    me->calGen    = 0U;
+    me->calTicks  = 0U;
+    me->calLinked = false;
+#endif
 
     /* Create a timer object */
     me->timer = xTimerCreateStatic("TE", 1U, me->type, me, TimeEvent_callback, &me->timer_cb);
     configASSERT(me->timer); /* timer must be created */
 }
 
+#if CONFIG_FREEACT_CALENDAR
+static void TimeEvent_calCancel(TimeEvent* const me, TickType_t ticks);
+static bool TimeEvent_calDue(TimeEvent* const me);
+#endif
+
+/*..........................................................................*/
+/* a timer period of 'millisec', at least one tick */
+TickType_t TimeEvent_msToTicks(uint32_t millisec)
+{
+    TickType_t ticks = (millisec / portTICK_PERIOD_MS);
+    if (ticks == 0U)
+    {
+        ticks = 1U;
+    }
+    return ticks;
+}
+
 /*..........................................................................*/
+/* task context only, use TimeEvent_armFromISR() in ISRs */
 void TimeEvent_arm(TimeEvent* const me, uint32_t millisec)
 {
-    TickType_t ticks;
+    TickType_t const ticks = TimeEvent_msToTicks(millisec);
+    BaseType_t       status;
+
+#if CONFIG_FREEACT_CALENDAR
+    TimeEvent_calCancel(me, ticks);
+#endif
+    status = xTimerChangePeriod(me->timer, ticks, 0);
+    configASSERT(status == pdPASS);
+}
+
+/*..........................................................................*/
+/* task context only, use TimeEvent_disarmFromISR() in ISRs */
+void TimeEvent_disarm(TimeEvent* const me)
+{
     BaseType_t status;
-    BaseType_t xHigherPriorityTaskWoken;
 
-    ticks = (millisec / portTICK_PERIOD_MS);
-    if (ticks == 0U)
+#if CONFIG_FREEACT_CALENDAR
+    TimeEvent_calCancel(me, 0U);
+#endif
+    status = xTimerStop(me->timer, 0);
+    configASSERT(status == pdPASS);
+}
+
+/*..........................................................................*/
+/* Accumulates into '*pxHigherPriorityTaskWoken' like Active_postFromISR();
+ * the ISR yields once, at its end, with portYIELD_FROM_ISR().
+ */
+void TimeEvent_armFromISR(TimeEvent* const me, uint32_t millisec, BaseType_t* pxHigherPriorityTaskWoken)
+{
+    TickType_t const ticks = TimeEvent_msToTicks(millisec);
+    BaseType_t       status;
+
+#if CONFIG_FREEACT_CALENDAR
+    TimeEvent_calCancel(me, ticks);
+#endif
+    status = xTimerChangePeriodFromISR(me->timer, ticks, pxHigherPriorityTaskWoken);
+    configASSERT(status == pdPASS);
+}
+
+/*..........................................................................*/
+void TimeEvent_disarmFromISR(TimeEvent* const me, BaseType_t* pxHigherPriorityTaskWoken)
+{
+    BaseType_t status;
+
+#if CONFIG_FREEACT_CALENDAR
+    TimeEvent_calCancel(me, 0U);
+#endif
+    status = xTimerStopFromISR(me->timer, pxHigherPriorityTaskWoken);
+    configASSERT(status == pdPASS);
+}
+
+/*..........................................................................*/
+/* Use this macro to get the container of TimeEvent struct
+ *  since xTimer pointing to timer_cb
+ */
+#define GET_TIME_EVENT_HEAD(ptr) (TimeEvent*)((uintptr_t)(ptr) - offsetof(TimeEvent, timer_cb))
+
+static void TimeEvent_callback(TimerHandle_t xTimer)
+{
+    /* Also can use pvTimerGetTimerID(xTimer) */
+    TimeEvent* const t = GET_TIME_EVENT_HEAD(xTimer);
+
+    /* Callback always called from non-interrupt context so no need
+     * to check xPortInIsrContext
+     */
+#if CONFIG_FREEACT_CALENDAR
+    if (!TimeEvent_calDue(t))
     {
-        ticks = 1U;
+        return; /* early (long wait or clock change): re-armed */
+    }
+#endif
+#if CONFIG_FREEACT_COPY_EVENTS
+    if (t->act->copySize != 0U)
+    {
+        Active_postCopy(t->act, &t->super, sizeof(Event)); /* a TimeEvent carries its signal only */
+        return;
+    }
+#endif
+    Active_post(t->act, &t->super);
+}
+
+#if CONFIG_FREEACT_CALENDAR
+/*--------------------------------------------------------------------------*/
+/* Calendar Time Event services... */
+#define CAL_MAX_WAIT_S  86400   /* longest single FreeRTOS timer wait */
+#define CAL_SEARCH_STEP 20000U  /* bound on CalSchedule_next() steps */
+
+static TimeEvent* volatile l_calendar; /* calendar TimeEvents, only ever added */
+static portMUX_TYPE        l_calLock = portMUX_INITIALIZER_UNLOCKED;
+
+/*..........................................................................*/
+/* a new arming ('ticks' from TimeEvent_arm(), 0 for a disarm) ends the
+ * calendar arming
+ */
+static void TimeEvent_calCancel(TimeEvent* const me, TickType_t ticks)
+{
+    portENTER_CRITICAL_SAFE(&l_calLock);
+    me->at       = 0;
+    me->cal      = (CalSchedule const*)0;
+    me->calTicks = ticks;
+    ++me->calGen;
+    portEXIT_CRITICAL_SAFE(&l_calLock);
+}
+
+/*..........................................................................*/
+/* arm the FreeRTOS timer for the wall-clock time left until 'at' */
+static void TimeEvent_calArm(TimeEvent* const me, time_t at)
+{
+    time_t const left = at - time((time_t*)0);
+    uint32_t     ms   = 1U; /* already due: as soon as possible */
+    BaseType_t   status;
+
+    if (left > 0)
+    {
+        ms = (uint32_t)((left < CAL_MAX_WAIT_S) ? left : CAL_MAX_WAIT_S) * 1000U;
     }
+    status = xTimerChangePeriod(me->timer, TimeEvent_msToTicks(ms), 0);
+    configASSERT(status == pdPASS);
+}
+
+/*..........................................................................*/
+/* Re-arm from the timer task for arming generation 'gen'. The timer
+ * command cannot be sent under the lock, so an arm or disarm from another
+ * context can slip in and have its own command queued before this one;
+ * until the generation is unchanged after sending, send again what the
+ * latest arming asks for.
+ */
+static void TimeEvent_calRearm(TimeEvent* const me, uint32_t gen, time_t at)
+{
+    TickType_t ticks = 0U;
+    bool       sent  = false;
 
-    if (xPortInIsrContext() == pdTRUE)
+    for (;;)
     {
-        xHigherPriorityTaskWoken = pdFALSE;
+        BaseType_t status;
 
-        status = xTimerChangePeriodFromISR(me->timer, ticks, &xHigherPriorityTaskWoken);
-        configASSERT(status == pdPASS);
+        portENTER_CRITICAL(&l_calLock);
+        if (me->calGen != gen)
+        {
+            gen   = me->calGen;
+            at    = me->at;
+            ticks = me->calTicks;
+        }
+        else if (sent)
+        {
+            portEXIT_CRITICAL(&l_calLock);
+            return;
+        }
+        portEXIT_CRITICAL(&l_calLock);
 
-        if (xHigherPriorityTaskWoken)
+        if (at != 0)
+        {
+            TimeEvent_calArm(me, at);
+        }
+        else if (ticks != 0U)
+        {
+            status = xTimerChangePeriod(me->timer, ticks, 0); /* re-armed by TimeEvent_arm() */
+            configASSERT(status == pdPASS);
+        }
+        else
         {
-            portYIELD_FROM_ISR();  // ESP-IDF: no argument
+            status = xTimerStop(me->timer, 0); /* disarmed, or no occurrence left */
+            configASSERT(status == pdPASS);
         }
+        sent = true;
+    }
+}
+
+/*..........................................................................*/
+/* replace the expiry of a recurring TimeEvent by its occurrence after
+ * 'now', unless arming generation 'gen' is over; returns the new expiry
+ */
+static time_t TimeEvent_calAdvance(TimeEvent* const me, CalSchedule const* cal, uint32_t gen, time_t now)
+{
+    time_t next = CalSchedule_next(cal, now); /* mktime() may lock: outside the critical section */
+
+    if (next < 0)
+    {
+        next = 0; /* never again */
+    }
+    portENTER_CRITICAL(&l_calLock);
+    if (me->calGen == gen)
+    {
+        me->at = next;
     }
     else
     {
-        status = xTimerChangePeriod(me->timer, ticks, 0);
-        configASSERT(status == pdPASS);
+        next = me->at; /* re-armed or cancelled meanwhile */
     }
+    portEXIT_CRITICAL(&l_calLock);
+
+    return next;
 }
 
 /*..........................................................................*/
-void TimeEvent_disarm(TimeEvent* const me)
+/* calendar bookkeeping on expiry; true if the event is to be posted */
+static bool TimeEvent_calDue(TimeEvent* const me)
 {
-    BaseType_t xHigherPriorityTaskWoken;
-    BaseType_t status;
+    time_t const       now = time((time_t*)0);
+    uint32_t           gen;
+    time_t             at;
+    CalSchedule const* cal;
+    TickType_t         ticks;
+    bool               linked;
 
-    if (xPortInIsrContext() == pdTRUE)
+    portENTER_CRITICAL(&l_calLock);
+    linked = me->calLinked;
+    gen    = me->calGen;
+    at     = me->at;
+    cal    = me->cal;
+    ticks  = me->calTicks;
+    if ((at != 0) && (now >= at) && (cal == (CalSchedule const*)0))
     {
-        xHigherPriorityTaskWoken = pdFALSE;
-        status                   = xTimerStopFromISR(me->timer, &xHigherPriorityTaskWoken);
-        configASSERT(status == pdPASS);
+        me->at = 0; /* one-shot: done */
+    }
+    portEXIT_CRITICAL(&l_calLock);
 
-        if (xHigherPriorityTaskWoken)
-        {
-            portYIELD_FROM_ISR();  // ESP-IDF: no argument
-        }
+    if (at == 0)
+    {
+        /* an ordinary TimeEvent, unless a disarm cancelled the calendar
+         * arming after this expiry was already under way
+         */
+        return !linked || (ticks != 0U);
     }
-    else
+    if (now < at)
     {
-        status = xTimerStop(me->timer, 0);
-        configASSERT(status == pdPASS);
+        TimeEvent_calRearm(me, gen, at); /* early: long wait or clock change */
+        return false;
+    }
+    if (cal != (CalSchedule const*)0)
+    {
+        TimeEvent_calRearm(me, gen, TimeEvent_calAdvance(me, cal, gen, now));
     }
+    return true;
 }
 
 /*..........................................................................*/
-/* Use this macro to get the container of TimeEvent struct
- *  since xTimer pointing to timer_cb
+static void TimeEvent_calStart(TimeEvent* const me, time_t at, CalSchedule const* sched)
+{
+    configASSERT(me->type == TYPE_ONE_SHOT); /* re-armed by the calendar */
+
+    portENTER_CRITICAL(&l_calLock);
+    me->at       = at;
+    me->cal      = sched;
+    me->calTicks = 0U;
+    ++me->calGen;
+    if (!me->calLinked)
+    {
+        me->calLinked = true;
+        me->calNext   = l_calendar;
+        l_calendar    = me;
+    }
+    portEXIT_CRITICAL(&l_calLock);
+
+    TimeEvent_calArm(me, at);
+}
+
+/*..........................................................................*/
+void TimeEvent_armAt(TimeEvent* const me, time_t when)
+{
+    configASSERT(when > 0);
+    TimeEvent_calStart(me, when, (CalSchedule const*)0);
+}
+
+/*..........................................................................*/
+void TimeEvent_armCal(TimeEvent* const me, CalSchedule const* sched)
+{
+    time_t const at = CalSchedule_next(sched, time((time_t*)0));
+
+    configASSERT(at > 0); /* the schedule must match some day */
+    TimeEvent_calStart(me, at, sched);
+}
+
+/*..........................................................................*/
+/* Steps through local time from the minute after 'after', skipping whole
+ * months, days and hours that cannot match; mktime() normalizes the
+ * fields (and DST) after every step.
  */
-#define GET_TIME_EVENT_HEAD(ptr) (TimeEvent*)((uintptr_t)(ptr) - offsetof(TimeEvent, timer_cb))
+time_t CalSchedule_next(CalSchedule const* const s, time_t after)
+{
+    struct tm t;
+    uint32_t  i;
 
-static void TimeEvent_callback(TimerHandle_t xTimer)
+    (void)localtime_r(&after, &t);
+    t.tm_sec = 0;
+    ++t.tm_min;
+
+    for (i = 0U; i < CAL_SEARCH_STEP; ++i)
+    {
+        time_t cand;
+
+        t.tm_isdst = -1;
+        cand       = mktime(&t);
+        if ((s->months & (1U << (t.tm_mon + 1))) == 0U)
+        {
+            ++t.tm_mon;
+            t.tm_mday = 1;
+            t.tm_hour = 0;
+            t.tm_min  = 0;
+        }
+        else if (((s->mdays & (1UL << t.tm_mday)) == 0U) || ((s->wdays & (1U << t.tm_wday)) == 0U))
+        {
+            ++t.tm_mday;
+            t.tm_hour = 0;
+            t.tm_min  = 0;
+        }
+        else if ((s->hours & (1UL << t.tm_hour)) == 0U)
+        {
+            ++t.tm_hour;
+            t.tm_min = 0;
+        }
+        else if ((s->minutes & (1ULL << t.tm_min)) == 0U)
+        {
+            ++t.tm_min;
+        }
+        else
+        {
+            return cand;
+        }
+    }
+    return (time_t)-1;
+}
+
+/*..........................................................................*/
+void FreeAct_clockChanged(void)
 {
-    /* Also can use pvTimerGetTimerID(xTimer) */
-    TimeEvent* const t = GET_TIME_EVENT_HEAD(xTimer);
+    time_t const now = time((time_t*)0);
+    TimeEvent*   t;
 
-    /* Callback always called from non-interrupt context so no need
-     * to check xPortInIsrContext
-     */
-    Active_post(t->act, &t->super);
+    for (t = l_calendar; t != (TimeEvent*)0; t = t->calNext)
+    {
+        uint32_t           gen;
+        time_t             at;
+        CalSchedule const* cal;
+
+        portENTER_CRITICAL(&l_calLock);
+        gen = t->calGen;
+        at  = t->at;
+        cal = t->cal;
+        portEXIT_CRITICAL(&l_calLock);
+
+        if (at == 0)
+        {
+            continue; /* not calendar-armed */
+        }
+        if (cal != (CalSchedule const*)0)
+        {
+            at = TimeEvent_calAdvance(t, cal, gen, now); /* was computed against the old clock */
+        }
+        TimeEvent_calRearm(t, gen, at);
+    }
 }
+#endif /* CONFIG_FREEACT_CALENDAR */
@@ -0,0 +1,102 @@
+/*****************************************************************************
+ * FreeAct windowed aggregation Active Object
+ *
+ * MIT License, see FreeAct.h
+ *****************************************************************************/
+#include "FreeAct_aggregator.h" /* Aggregator interface */
+
+#include <limits.h>
+
+/*..........................................................................*/
+static void Aggregator_reset(Aggregator* const me)
+{
+    me->sum   = 0;
+    me->min   = INT32_MAX;
+    me->max   = INT32_MIN;
+    me->count = 0U;
+}
+
+/*..........................................................................*/
+/* post the summary of the current window and start a new one */
+static void Aggregator_emit(Aggregator* const me)
+{
+    SummaryEvt* const out = &me->out[me->outIdx];
+
+    if (me->count == 0U)
+    {
+        return; /* empty window, nothing to report */
+    }
+
+    out->min   = me->min;
+    out->max   = me->max;
+    out->mean  = (int32_t)(me->sum / (int64_t)me->count);
+    out->count = me->count;
+    me->outIdx ^= 1U;
+
+    Active_post(me->target, &out->super);
+    Aggregator_reset(me);
+}
+
+/*..........................................................................*/
+static void Aggregator_dispatch(Aggregator* const me, Event const* const e)
+{
+    if (e->sig == INIT_SIG)
+    {
+#if CONFIG_FREEACT_COPY_EVENTS
+        configASSERT(me->super.copySize == 0U); /* the window TimeEvent is recognized by address */
+#endif
+        Aggregator_reset(me);
+        if (me->windowMs != 0U)
+        {
+            TimeEvent_arm(&me->te, me->windowMs);
+        }
+    }
+    else if (e == &me->te.super)
+    {
+        Aggregator_emit(me); /* the time window closed */
+    }
+    else if (e->sig == me->sampleSig)
+    {
+        int32_t const value = ((SampleEvt const*)e)->value;
+
+        me->sum += value;
+        if (value < me->min)
+        {
+            me->min = value;
+        }
+        if (value > me->max)
+        {
+            me->max = value;
+        }
+        ++me->count;
+
+        if ((me->windowCount != 0U) && (me->count >= me->windowCount))
+        {
+            Aggregator_emit(me); /* the count window closed */
+        }
+    }
+}
+
+/*..........................................................................*/
+void Aggregator_ctor(Aggregator* const me, Signal sampleSig, Active* target, Signal summarySig, uint32_t windowCount,
+                     uint32_t windowMs)
+{
+    configASSERT((windowCount != 0U) || (windowMs != 0U)); /* some window is needed */
+
+    Active_ctor(&me->super, (DispatchHandler)&Aggregator_dispatch);
+
+    /* the window timer is recognized by identity, so its signal only
+     * has to differ from INIT_SIG
+     */
+    me->te.type = TYPE_PERIODIC;
+    TimeEvent_ctor(&me->te, USER_SIG, &me->super);
+
+    me->target           = target;
+    me->sampleSig        = sampleSig;
+    me->windowCount      = windowCount;
+    me->windowMs         = windowMs;
+    me->out[0].super.sig = summarySig;
+    me->out[1].super.sig = summarySig;
+    me->outIdx           = 0U;
+    Aggregator_reset(me);
+}
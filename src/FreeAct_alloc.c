@@ -0,0 +1,74 @@
+/*****************************************************************************
+ * FreeAct hot-path allocation detector
+ *
+ * MIT License, see FreeAct.h
+ *****************************************************************************/
+#include "FreeAct.h" /* Free Active Object interface */
+
+#include <stdlib.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#if !CONFIG_IDF_TARGET_LINUX
+#include "esp_heap_caps.h"
+#endif
+
+/*..........................................................................*/
+/* attribute one allocation to the AO dispatching on the calling task; runs
+ * on every allocation, so the lookup is the O(1) thread-local one
+ */
+static void FreeAct_checkAlloc(size_t size)
+{
+    Active*      act;
+    Event const* e;
+
+    if (xPortInIsrContext() || (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED))
+    {
+        return; /* not on behalf of a task */
+    }
+    act = Active_currentOf((TaskHandle_t)0, &e); /* NULL for host pthreads that are no AO thread */
+    if (act != (Active*)0)
+    {
+        FreeAct_onDispatchAlloc(act, e->sig, size);
+    }
+}
+
+#if CONFIG_IDF_TARGET_LINUX
+/*..........................................................................*/
+/* the linker routes malloc()/calloc()/realloc() here (-Wl,--wrap) */
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t n, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size)
+{
+    void* const ptr = __real_malloc(size);
+    FreeAct_checkAlloc(size);
+    return ptr;
+}
+
+void* __wrap_calloc(size_t n, size_t size)
+{
+    void* const ptr = __real_calloc(n, size);
+    FreeAct_checkAlloc(n * size);
+    return ptr;
+}
+
+void* __wrap_realloc(void* ptr, size_t size)
+{
+    void* const p = __real_realloc(ptr, size);
+    FreeAct_checkAlloc(size);
+    return p;
+}
+
+#else
+/*..........................................................................*/
+/* heap_caps allocation hook (CONFIG_HEAP_USE_HOOKS), covers malloc() too */
+void esp_heap_trace_alloc_hook(void* ptr, size_t size, uint32_t caps)
+{
+    (void)ptr;
+    (void)caps;
+    FreeAct_checkAlloc(size);
+}
+#endif
@@ -0,0 +1,161 @@
+/*****************************************************************************
+ * FreeAct asynchronous file and flash I/O
+ *
+ * MIT License, see FreeAct.h
+ *****************************************************************************/
+#include "FreeAct_asyncio.h" /* Async I/O interface */
+
+#include <errno.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "nvs.h"
+
+/*..........................................................................*/
+static int32_t AsyncIo_file(AsyncIoReq const* const req)
+{
+    FILE*   f;
+    size_t  n;
+    int32_t result;
+
+    switch (req->op)
+    {
+        case AIO_READ:
+            f = fopen(req->path, "rb");
+            break;
+        case AIO_WRITE:
+            f = fopen(req->path, "r+b");
+            if ((f == (FILE*)0) && (errno == ENOENT))
+            {
+                f = fopen(req->path, "w+b");
+            }
+            break;
+        default: /* AIO_APPEND */
+            f = fopen(req->path, "ab");
+            break;
+    }
+    if (f == (FILE*)0)
+    {
+        return -errno;
+    }
+
+    if ((req->op != AIO_APPEND) && (fseek(f, req->offset, SEEK_SET) != 0))
+    {
+        result = -errno;
+    }
+    else if (req->op == AIO_READ)
+    {
+        n      = fread(req->buf, 1U, req->len, f);
+        result = ferror(f) ? -EIO : (int32_t)n;
+    }
+    else
+    {
+        n      = fwrite(req->buf, 1U, req->len, f);
+        result = (n == req->len) ? (int32_t)n : -EIO;
+        if ((result >= 0) && ((fflush(f) != 0) || (fsync(fileno(f)) != 0)))
+        {
+            result = -errno; /* not durable */
+        }
+    }
+
+    if ((fclose(f) != 0) && (result >= 0))
+    {
+        result = -errno;
+    }
+    return result;
+}
+
+/*..........................................................................*/
+/* NVS errors are esp_err_t codes, not errno values: they go to 'err' */
+static esp_err_t AsyncIo_nvs(AsyncIoReq* const req)
+{
+    nvs_handle_t h;
+    esp_err_t    err;
+    size_t       len = req->len;
+
+    err = nvs_open(req->path, (req->op == AIO_NVS_GET) ? NVS_READONLY : NVS_READWRITE, &h);
+    if (err != ESP_OK)
+    {
+        req->result = -EIO;
+        return err;
+    }
+
+    switch (req->op)
+    {
+        case AIO_NVS_GET:
+            err = nvs_get_blob(h, req->key, req->buf, &len);
+            break;
+        case AIO_NVS_SET:
+            err = nvs_set_blob(h, req->key, req->buf, req->len);
+            if (err == ESP_OK)
+            {
+                err = nvs_commit(h);
+            }
+            break;
+        default: /* AIO_NVS_ERASE */
+            len = 0U;
+            err = nvs_erase_key(h, req->key);
+            if (err == ESP_OK)
+            {
+                err = nvs_commit(h);
+            }
+            break;
+    }
+    nvs_close(h);
+
+    req->result = (err == ESP_OK) ? (int32_t)len : -EIO;
+    return err;
+}
+
+/*..........................................................................*/
+/* Blocking is what this AO is for: it owns no time-critical state, and
+ * every other AO stays responsive while it waits on the storage.
+ */
+static void AsyncIo_dispatch(AsyncIo* const me, Event const* const e)
+{
+    AsyncIoReq* req;
+
+    (void)me;
+    if (e->sig == INIT_SIG)
+    {
+#if CONFIG_FREEACT_COPY_EVENTS
+        configASSERT(me->super.copySize == 0U); /* items must be request pointers */
+#endif
+        return;
+    }
+
+    req = (AsyncIoReq*)e; /* every other event is a request */
+    switch (req->op)
+    {
+        case AIO_READ:
+        case AIO_WRITE:
+        case AIO_APPEND:
+            req->result = AsyncIo_file(req);
+            req->err    = (req->result < 0) ? ESP_FAIL : ESP_OK;
+            break;
+        default:
+            req->err = AsyncIo_nvs(req);
+            break;
+    }
+
+    Active_post(req->act, &req->super); /* completion */
+}
+
+/*..........................................................................*/
+void AsyncIo_ctor(AsyncIo* const me)
+{
+    Active_ctor(&me->super, (DispatchHandler)&AsyncIo_dispatch);
+#if CONFIG_FREEACT_BLOCK_CHECK
+    Active_allowBlocking(&me->super); /* blocking I/O is this AO's job */
+#endif
+}
+
+/*..........................................................................*/
+void AsyncIo_submit(AsyncIo* const me, AsyncIoReq* const req)
+{
+    configASSERT((req->act != (Active*)0) && (req->super.sig != INIT_SIG));
+#if CONFIG_FREEACT_COPY_EVENTS
+    configASSERT(me->super.copySize == 0U); /* the request is completed in place */
+#endif
+    Active_post(&me->super, &req->super);
+}
@@ -0,0 +1,76 @@
+/*****************************************************************************
+ * FreeAct blocking-call detector
+ *
+ * MIT License, see FreeAct.h
+ *****************************************************************************/
+#include "FreeAct.h" /* Free Active Object interface */
+
+#include "esp_attr.h"
+#include "esp_timer.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static uint32_t volatile l_nBlocked; /* AOs blocked inside a dispatch right now */
+static portMUX_TYPE      l_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/*..........................................................................*/
+void Active_allowBlocking(Active* const me)
+{
+    me->blkExempt = true;
+}
+
+/*..........................................................................*/
+/* the calling task is about to block (called by the kernel) */
+void FreeAct_blockHook(void const* obj, int kind)
+{
+    Event const* e;
+    Active*      act = Active_currentOf((TaskHandle_t)0, &e);
+
+    if ((act == (Active*)0) || act->blkExempt)
+    {
+        return; /* blocking outside a dispatch (or by design) is fine */
+    }
+    if (act->blk.count == 0U)
+    {
+        act->blk.obj  = obj;
+        act->blk.kind = (uint8_t)kind;
+    }
+    ++act->blk.count;
+
+    portENTER_CRITICAL_SAFE(&l_lock);
+    if (act->blkSince == 0)
+    {
+        act->blkSince = esp_timer_get_time(); /* shared by both cores */
+        ++l_nBlocked;
+    }
+    portEXIT_CRITICAL_SAFE(&l_lock);
+}
+
+/*..........................................................................*/
+/* a task resumes (called by the kernel on every context switch, possibly
+ * with the flash cache disabled: only IRAM code and DRAM data here)
+ */
+void IRAM_ATTR FreeAct_switchedInHook(void)
+{
+    Active* act;
+
+    if (l_nBlocked == 0U)
+    {
+        return; /* the common case: one load */
+    }
+    act = (Active*)pvTaskGetThreadLocalStoragePointer((TaskHandle_t)0, CONFIG_FREEACT_CURRENT_TLS_INDEX);
+    if (act == (Active*)0)
+    {
+        return;
+    }
+
+    portENTER_CRITICAL_SAFE(&l_lock);
+    if (act->blkSince != 0)
+    {
+        act->blk.blockedUs += (uint32_t)(esp_timer_get_time() - act->blkSince);
+        act->blkSince = 0;
+        --l_nBlocked;
+    }
+    portEXIT_CRITICAL_SAFE(&l_lock);
+}
@@ -0,0 +1,85 @@
+/*****************************************************************************
+ * FreeAct bus transaction manager
+ *
+ * MIT License, see FreeAct.h
+ *****************************************************************************/
+#include "FreeAct_bus.h" /* Bus manager interface */
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+/*..........................................................................*/
+/* batching drains the AO's own queue of event pointers: it needs a private,
+ * plain queue
+ */
+static void BusMgr_checkQueue(BusMgr const* const me)
+{
+#if CONFIG_FREEACT_COOP_SCHED
+    configASSERT(me->super.sched == (ActiveSched*)0); /* shared queues hold SchedItems */
+#endif
+#if CONFIG_FREEACT_ELASTIC_QUEUE
+    configASSERT(me->super.ovfSto == (Event const**)0); /* the drain would bypass the overflow ring */
+#endif
+#if CONFIG_FREEACT_COPY_EVENTS
+    configASSERT(me->super.copySize == 0U); /* items must be event pointers */
+#endif
+    (void)me;
+}
+
+/*..........................................................................*/
+static void BusMgr_dispatch(BusMgr* const me, Event const* const e)
+{
+    BusTxn*      batch[CONFIG_FREEACT_BUS_BATCH_MAX];
+    Event const* next;
+    uint8_t      n = 0U;
+    uint8_t      i;
+
+    if (e->sig == INIT_SIG)
+    {
+        BusMgr_checkQueue(me);
+        return;
+    }
+
+    /* every other event is a transaction; merge the queued ones that
+     * immediately follow and target the same device
+     */
+    batch[n++] = (BusTxn*)e;
+    while ((n < CONFIG_FREEACT_BUS_BATCH_MAX) && (xQueuePeek(me->super.queue, &next, (TickType_t)0) == pdTRUE) &&
+           (((BusTxn const*)next)->dev == batch[0]->dev))
+    {
+        (void)xQueueReceive(me->super.queue, &next, (TickType_t)0);
+        batch[n++] = (BusTxn*)next;
+    }
+
+    (*me->backend->run)(me->ctx, batch[0]->dev, batch, n); /* the bus is this AO's job */
+    ++me->nBatches;
+    me->nTxns += n;
+
+    for (i = 0U; i < n; ++i)
+    {
+        Active_post(batch[i]->act, &batch[i]->super); /* completion */
+    }
+}
+
+/*..........................................................................*/
+void BusMgr_ctor(BusMgr* const me, BusBackend const* backend, void* ctx)
+{
+    configASSERT((backend != (BusBackend const*)0) && (backend->run != 0));
+
+    Active_ctor(&me->super, (DispatchHandler)&BusMgr_dispatch);
+#if CONFIG_FREEACT_BLOCK_CHECK
+    Active_allowBlocking(&me->super); /* the backend blocks on the bus */
+#endif
+    me->backend  = backend;
+    me->ctx      = ctx;
+    me->nBatches = 0U;
+    me->nTxns    = 0U;
+}
+
+/*..........................................................................*/
+void BusMgr_submit(BusMgr* const me, BusTxn* const txn)
+{
+    configASSERT((txn->act != (Active*)0) && (txn->super.sig != INIT_SIG));
+    BusMgr_checkQueue(me);
+    Active_post(&me->super, &txn->super);
+}
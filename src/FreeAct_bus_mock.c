@@ -0,0 +1,53 @@
+/*****************************************************************************
+ * FreeAct bus transaction manager: mock backend
+ *
+ * MIT License, see FreeAct.h
+ *****************************************************************************/
+#include "FreeAct_bus_mock.h" /* mock backend interface */
+
+#include <string.h>
+
+/*..........................................................................*/
+void BusMock_ctor(BusMock* const me, esp_err_t result)
+{
+    me->result  = result;
+    me->nRuns   = 0U;
+    me->nTxns   = 0U;
+    me->lastDev = (void*)0;
+    me->lastN   = 0U;
+}
+
+/*..........................................................................*/
+static void BusMock_run(void* ctx, void* dev, BusTxn* const* txns, uint8_t n)
+{
+    BusMock* const me = (BusMock*)ctx;
+    uint8_t        i;
+
+    for (i = 0U; i < n; ++i)
+    {
+        BusTxn* const t = txns[i];
+
+        configASSERT(t->dev == dev); /* a batch targets one device */
+        if (t->rx != (void*)0)
+        {
+            if (t->tx != (void const*)0)
+            {
+                memcpy(t->rx, t->tx, t->len); /* loopback */
+            }
+            else
+            {
+                memset(t->rx, 0, t->len);
+            }
+        }
+        t->result = me->result;
+    }
+    ++me->nRuns;
+    me->nTxns += n;
+    me->lastDev = dev;
+    me->lastN   = n;
+}
+
+/*..........................................................................*/
+BusBackend const BusMock_backend = {
+    .run = &BusMock_run,
+};
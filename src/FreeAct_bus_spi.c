@@ -0,0 +1,61 @@
+/*****************************************************************************
+ * FreeAct bus transaction manager: SPI master backend
+ *
+ * MIT License, see FreeAct.h
+ *****************************************************************************/
+#include "FreeAct_bus_spi.h" /* SPI backend interface */
+
+#include <string.h>
+
+/*..........................................................................*/
+static void BusSpi_run(void* ctx, void* dev, BusTxn* const* txns, uint8_t n)
+{
+    BusSpi* const             me     = (BusSpi*)ctx;
+    spi_device_handle_t const handle = (spi_device_handle_t)dev;
+    spi_transaction_t*        done;
+    esp_err_t                 err;
+    bool                      acquired;
+    uint8_t                   queued = 0U;
+    uint8_t                   i;
+
+    err      = spi_device_acquire_bus(handle, portMAX_DELAY);
+    acquired = (err == ESP_OK);
+    for (i = 0U; (err == ESP_OK) && (i < n); ++i)
+    {
+        spi_transaction_t* const t = &me->trans[i];
+
+        memset(t, 0, sizeof(*t));
+        t->flags     = txns[i]->flags;
+        t->length    = txns[i]->len * 8U;
+        t->rxlength  = (txns[i]->rx != (void*)0) ? (txns[i]->len * 8U) : 0U;
+        t->tx_buffer = txns[i]->tx;
+        t->rx_buffer = txns[i]->rx;
+        t->user      = txns[i];
+
+        err = spi_device_queue_trans(handle, t, portMAX_DELAY);
+        if (err == ESP_OK)
+        {
+            ++queued;
+        }
+    }
+    for (i = queued; i < n; ++i)
+    {
+        txns[i]->result = err; /* never reached the bus */
+    }
+
+    /* results come back in queuing order */
+    for (i = 0U; i < queued; ++i)
+    {
+        txns[i]->result = spi_device_get_trans_result(handle, &done, portMAX_DELAY);
+    }
+
+    if (acquired)
+    {
+        spi_device_release_bus(handle);
+    }
+}
+
+/*..........................................................................*/
+BusBackend const BusSpi_backend = {
+    .run = &BusSpi_run,
+};
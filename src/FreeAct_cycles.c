@@ -0,0 +1,91 @@
+/*****************************************************************************
+ * FreeAct cycle counter
+ *
+ * MIT License, see FreeAct.h
+ *****************************************************************************/
+#include "FreeAct_cycles.h" /* cycle counter interface */
+
+#include "esp_timer.h"
+
+#define CALIB_US     10000 /* rate measurement window */
+#define CALIB_ROUNDS 16U   /* back-to-back reads for the overhead */
+
+static uint32_t l_hz;          /* counter rate, 0 until calibrated */
+static uint32_t l_nsPerCycleQ; /* ns per cycle, Q16 fixed point */
+static uint32_t l_overhead;    /* cycles of one reading */
+
+/*..........................................................................*/
+void FreeAct_cyclesCalibrate(void)
+{
+    uint32_t min = UINT32_MAX;
+    uint32_t c0;
+    uint32_t c1;
+    int64_t  t0;
+    int64_t  t1;
+    uint32_t i;
+
+#if CONFIG_IDF_TARGET_LINUX
+    (void)c0;
+    (void)t0;
+    (void)t1;
+    l_hz = 1000000000U; /* the host clock counts nanoseconds */
+#else
+    /* time a window of esp_timer against the counter, starting on a fresh
+     * microsecond so the window is not cut short
+     */
+    t0 = esp_timer_get_time();
+    while ((t1 = esp_timer_get_time()) == t0)
+    {
+    }
+    c0 = FreeAct_cycles();
+    while ((t0 = esp_timer_get_time()) < (t1 + CALIB_US))
+    {
+    }
+    c1   = FreeAct_cycles();
+    l_hz = (uint32_t)(((uint64_t)(c1 - c0) * 1000000U) / (uint64_t)(t0 - t1));
+#endif
+    l_nsPerCycleQ = (uint32_t)((1000000000ULL << 16) / l_hz);
+
+    /* the cheapest of several back-to-back reads: cache and interrupt free */
+    for (i = 0U; i < CALIB_ROUNDS; ++i)
+    {
+        c0 = FreeAct_cycles();
+        c1 = FreeAct_cycles();
+        if ((c1 - c0) < min)
+        {
+            min = c1 - c0;
+        }
+    }
+    l_overhead = min;
+}
+
+/*..........................................................................*/
+uint32_t FreeAct_cyclesHz(void)
+{
+    if (l_hz == 0U)
+    {
+        FreeAct_cyclesCalibrate();
+    }
+    return l_hz;
+}
+
+/*..........................................................................*/
+uint32_t FreeAct_cyclesOverhead(void)
+{
+    if (l_hz == 0U)
+    {
+        FreeAct_cyclesCalibrate();
+    }
+    return l_overhead;
+}
+
+/*..........................................................................*/
+uint32_t FreeAct_cyclesToNs(uint32_t cycles)
+{
+    if (l_hz == 0U)
+    {
+        FreeAct_cyclesCalibrate();
+    }
+    cycles = (cycles > l_overhead) ? (cycles - l_overhead) : 0U;
+    return (uint32_t)(((uint64_t)cycles * l_nsPerCycleQ) >> 16);
+}
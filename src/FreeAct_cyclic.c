@@ -0,0 +1,141 @@
+/*****************************************************************************
+ * FreeAct time-triggered cyclic executive
+ *
+ * MIT License, see FreeAct.h
+ *****************************************************************************/
+#include "FreeAct_cyclic.h" /* Cyclic executive interface */
+
+#include <string.h>
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+#define TAG "FreeAct"
+
+static void CyclicExec_callback(void* arg);
+
+/*..........................................................................*/
+void CyclicExec_ctor(CyclicExec* const me, CyclicFrame const* frames, CyclicFrameStats* stats, uint16_t nFrames,
+                     uint32_t periodUs)
+{
+    configASSERT((frames != NULL) && (stats != NULL) && (nFrames > 0U));
+    configASSERT(periodUs > 0U);
+
+    me->frames   = frames;
+    me->stats    = stats;
+    me->nFrames  = nFrames;
+    me->curr     = 0U;
+    me->periodUs = periodUs;
+    me->nTicks   = 0U;
+    me->t0       = 0;
+    memset(stats, 0, nFrames * sizeof(CyclicFrameStats));
+
+    esp_timer_create_args_t const args = {
+        .callback              = &CyclicExec_callback,
+        .arg                   = me,
+        .dispatch_method       = ESP_TIMER_TASK,
+        .name                  = "CE",
+        .skip_unhandled_events = false, /* late frames are released, not lost */
+    };
+    esp_err_t err = esp_timer_create(&args, &me->timer);
+    configASSERT(err == ESP_OK); /* timer must be created */
+}
+
+/*..........................................................................*/
+void CyclicExec_start(CyclicExec* const me)
+{
+    me->nTicks = 0U;
+    me->curr   = me->nFrames - 1U; /* the first release is frame #0 */
+    me->t0     = esp_timer_get_time() + me->periodUs;
+
+    esp_err_t err = esp_timer_start_periodic(me->timer, me->periodUs);
+    configASSERT(err == ESP_OK);
+}
+
+/*..........................................................................*/
+void CyclicExec_stop(CyclicExec* const me)
+{
+    (void)esp_timer_stop(me->timer); /* ESP_ERR_INVALID_STATE if not running */
+}
+
+/*..........................................................................*/
+/* the AO has not finished its previous activation */
+static bool CyclicExec_isBusy(Active* const act)
+{
+    return Active_isDispatching(act) || (uxQueueMessagesWaiting(act->queue) != 0U);
+}
+
+/*..........................................................................*/
+static void CyclicExec_callback(void* arg)
+{
+    CyclicExec* const  me  = (CyclicExec*)arg;
+    int64_t const      now = esp_timer_get_time();
+    CyclicFrame const* prev;
+    CyclicFrame const* frame;
+    CyclicFrameStats*  stats;
+    int64_t            jitter;
+    uint16_t           i;
+
+    /* the work released at the previous boundary must be complete by now */
+    prev = &me->frames[me->curr];
+    if (me->nTicks != 0U)
+    {
+        for (i = 0U; i < prev->nSlots; ++i)
+        {
+            if (CyclicExec_isBusy(prev->slots[i].act))
+            {
+                ++me->stats[me->curr].nOverruns;
+                break;
+            }
+        }
+    }
+
+    /* advance to the next minor frame */
+    me->curr = (me->curr + 1U < me->nFrames) ? (me->curr + 1U) : 0U;
+    frame    = &me->frames[me->curr];
+    stats    = &me->stats[me->curr];
+
+    /* release jitter w.r.t. the ideal time-triggered schedule */
+    jitter = now - (me->t0 + (int64_t)(me->nTicks * me->periodUs));
+    if (jitter < 0)
+    {
+        jitter = -jitter;
+    }
+    ++me->nTicks;
+    ++stats->nReleases;
+    stats->lastJitterUs = (uint32_t)jitter;
+    if (stats->lastJitterUs > stats->maxJitterUs)
+    {
+        stats->maxJitterUs = stats->lastJitterUs;
+    }
+
+    /* release the frame, dropping activations the AO cannot take yet */
+    for (i = 0U; i < frame->nSlots; ++i)
+    {
+        CyclicSlot const* const slot = &frame->slots[i];
+        if (CyclicExec_isBusy(slot->act))
+        {
+            ++stats->nSkipped;
+        }
+        else
+        {
+            Active_post(slot->act, slot->evt);
+        }
+    }
+}
+
+/*..........................................................................*/
+void CyclicExec_report(CyclicExec const* const me)
+{
+    uint16_t i;
+
+    ESP_LOGI(TAG, "cyclic executive: %u frames x %lu us", (unsigned)me->nFrames, (unsigned long)me->periodUs);
+    for (i = 0U; i < me->nFrames; ++i)
+    {
+        CyclicFrameStats const* const stats = &me->stats[i];
+        ESP_LOGI(TAG, "  frame %u: released=%lu overruns=%lu skipped=%lu jitter=%lu us (max %lu us)", (unsigned)i,
+                 (unsigned long)stats->nReleases, (unsigned long)stats->nOverruns, (unsigned long)stats->nSkipped,
+                 (unsigned long)stats->lastJitterUs, (unsigned long)stats->maxJitterUs);
+    }
+}
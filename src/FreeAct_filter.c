@@ -0,0 +1,119 @@
+/*****************************************************************************
+ * FreeAct event-stream filters: debounce, throttle and sample
+ *
+ * MIT License, see FreeAct.h
+ *****************************************************************************/
+#include "FreeAct_filter.h" /* Event filter interface */
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/timers.h"
+
+static void EventFilter_callback(TimerHandle_t xTimer);
+
+/*..........................................................................*/
+void EventFilter_ctor(EventFilter* const me, FilterMode mode, Active* act, uint32_t millisec)
+{
+    /* no critical section because it is presumed that all filters
+     * are created *before* multitasking has started.
+     */
+    me->act    = act;
+    me->latest = (Event const*)0;
+    me->mode   = mode;
+    me->busy   = false;
+    portMUX_INITIALIZE(&me->lock);
+
+    me->timer = xTimerCreateStatic("EF", TimeEvent_msToTicks(millisec), (mode == FILTER_SAMPLE) ? pdTRUE : pdFALSE, me,
+                                   EventFilter_callback, &me->timer_cb);
+    configASSERT(me->timer); /* timer must be created */
+}
+
+/*..........................................................................*/
+/* filter state machine, called inside the critical section: decides whether
+ * 'e' is forwarded right away and whether the timer is (re)started
+ */
+static void EventFilter_update(EventFilter* const me, Event const* const e, bool* forward, bool* restart)
+{
+    switch (me->mode)
+    {
+        case FILTER_DEBOUNCE:
+            me->latest = e;
+            *restart   = true; /* every post extends the quiet period */
+            break;
+        case FILTER_THROTTLE:
+            *forward = !me->busy;
+            *restart = *forward; /* the first post opens the window */
+            me->busy = true;
+            break;
+        case FILTER_SAMPLE:
+            me->latest = e;
+            *restart   = !me->busy; /* the first post starts the sampler */
+            me->busy   = true;
+            break;
+    }
+}
+
+/*..........................................................................*/
+void EventFilter_post(EventFilter* const me, Event const* const e)
+{
+    bool       forward = false;
+    bool       restart = false;
+    BaseType_t status  = pdPASS;
+
+    portENTER_CRITICAL(&me->lock);
+    EventFilter_update(me, e, &forward, &restart);
+    portEXIT_CRITICAL(&me->lock);
+
+    if (forward)
+    {
+        Active_post(me->act, e);
+    }
+    if (restart)
+    {
+        status = xTimerReset(me->timer, 0);
+    }
+    configASSERT(status == pdPASS);
+}
+
+/*..........................................................................*/
+void EventFilter_postFromISR(EventFilter* const me, Event const* const e, BaseType_t* pxHigherPriorityTaskWoken)
+{
+    bool       forward = false;
+    bool       restart = false;
+    BaseType_t status  = pdPASS;
+
+    portENTER_CRITICAL_ISR(&me->lock);
+    EventFilter_update(me, e, &forward, &restart);
+    portEXIT_CRITICAL_ISR(&me->lock);
+
+    if (forward)
+    {
+        Active_postFromISR(me->act, e, pxHigherPriorityTaskWoken);
+    }
+    if (restart)
+    {
+        status = xTimerResetFromISR(me->timer, pxHigherPriorityTaskWoken);
+    }
+    configASSERT(status == pdPASS);
+}
+
+/*..........................................................................*/
+static void EventFilter_callback(TimerHandle_t xTimer)
+{
+    EventFilter* const me = (EventFilter*)pvTimerGetTimerID(xTimer);
+    Event const*       e;
+
+    /* Callback always called from non-interrupt context (timer task) */
+    portENTER_CRITICAL(&me->lock);
+    e          = me->latest;
+    me->latest = (Event const*)0;
+    if (me->mode == FILTER_THROTTLE)
+    {
+        me->busy = false; /* the throttle window closed */
+    }
+    portEXIT_CRITICAL(&me->lock);
+
+    if (e != (Event const*)0)
+    {
+        Active_post(me->act, e);
+    }
+}
@@ -0,0 +1,152 @@
+/*****************************************************************************
+ * FreeAct sampling profiler
+ *
+ * MIT License, see FreeAct.h
+ *****************************************************************************/
+#include "FreeAct_profiler.h" /* profiler interface */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "driver/gptimer.h"
+#include "esp_err.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#define PROFILER_RES_HZ 1000000U /* timer resolution */
+
+static ProfileEntry     l_table[CONFIG_FREEACT_PROFILER_SLOTS];
+static ProfileEntry     l_snap[CONFIG_FREEACT_PROFILER_SLOTS]; /* printed outside the lock */
+static uint32_t         l_dropped;                             /* samples that found the table full */
+static portMUX_TYPE     l_lock = portMUX_INITIALIZER_UNLOCKED;
+static gptimer_handle_t l_timer;
+
+/*..........................................................................*/
+/* count one sample; open addressing, the table is never rehashed */
+static void FreeAct_profilerCount(TaskHandle_t task, Active const* act, Signal sig)
+{
+    uintptr_t h = ((uintptr_t)task >> 2) ^ ((uintptr_t)act >> 2) ^ ((uintptr_t)sig * 2654435761U);
+    uint32_t  i;
+
+    for (i = 0U; i < CONFIG_FREEACT_PROFILER_SLOTS; ++i)
+    {
+        ProfileEntry* const p = &l_table[(h + i) % CONFIG_FREEACT_PROFILER_SLOTS];
+
+        if (p->task == (TaskHandle_t)0)
+        {
+            p->task = task;
+            p->act  = act;
+            p->fn   = (act != (Active const*)0) ? act->dispatch : (DispatchHandler)0;
+            p->sig  = sig;
+            strncpy(p->name, pcTaskGetName(task), sizeof(p->name) - 1U);
+        }
+        if ((p->task == task) && (p->act == act) && (p->sig == sig))
+        {
+            ++p->count;
+            return;
+        }
+    }
+    ++l_dropped;
+}
+
+/*..........................................................................*/
+static bool FreeAct_profilerSample(gptimer_handle_t timer, gptimer_alarm_event_data_t const* edata, void* user_ctx)
+{
+    BaseType_t core;
+
+    (void)timer;
+    (void)edata;
+    (void)user_ctx;
+
+    portENTER_CRITICAL_ISR(&l_lock);
+    for (core = 0; core < portNUM_PROCESSORS; ++core)
+    {
+        TaskHandle_t const task = xTaskGetCurrentTaskHandleForCore(core);
+        Event const*       e    = (Event const*)0;
+        Active const*      act;
+
+        if (task != (TaskHandle_t)0)
+        {
+            act = Active_currentOf(task, &e);
+            FreeAct_profilerCount(task, act, (e != (Event const*)0) ? e->sig : 0U);
+        }
+    }
+    portEXIT_CRITICAL_ISR(&l_lock);
+
+    return false; /* nothing was woken */
+}
+
+/*..........................................................................*/
+void FreeAct_profilerStart(uint32_t hz)
+{
+    gptimer_config_t const cfg = {
+        .clk_src       = GPTIMER_CLK_SRC_DEFAULT,
+        .direction     = GPTIMER_COUNT_UP,
+        .resolution_hz = PROFILER_RES_HZ,
+    };
+    gptimer_alarm_config_t const alarm = {
+        .alarm_count                = PROFILER_RES_HZ / hz,
+        .reload_count               = 0U,
+        .flags.auto_reload_on_alarm = true,
+    };
+    gptimer_event_callbacks_t const cbs = {
+        .on_alarm = &FreeAct_profilerSample,
+    };
+
+    configASSERT((hz > 0U) && (hz <= (PROFILER_RES_HZ / 10U)) && (l_timer == (gptimer_handle_t)0));
+
+    ESP_ERROR_CHECK(gptimer_new_timer(&cfg, &l_timer));
+    ESP_ERROR_CHECK(gptimer_set_alarm_action(l_timer, &alarm));
+    ESP_ERROR_CHECK(gptimer_register_event_callbacks(l_timer, &cbs, (void*)0));
+    ESP_ERROR_CHECK(gptimer_enable(l_timer));
+    ESP_ERROR_CHECK(gptimer_start(l_timer));
+}
+
+/*..........................................................................*/
+void FreeAct_profilerStop(void)
+{
+    configASSERT(l_timer != (gptimer_handle_t)0);
+
+    ESP_ERROR_CHECK(gptimer_stop(l_timer));
+    ESP_ERROR_CHECK(gptimer_disable(l_timer));
+    ESP_ERROR_CHECK(gptimer_del_timer(l_timer));
+    l_timer = (gptimer_handle_t)0;
+}
+
+/*..........................................................................*/
+void FreeAct_profilerDump(void)
+{
+    uint32_t dropped;
+    uint32_t i;
+
+    portENTER_CRITICAL(&l_lock);
+    memcpy(l_snap, l_table, sizeof(l_table));
+    memset(l_table, 0, sizeof(l_table));
+    dropped   = l_dropped;
+    l_dropped = 0U;
+    portEXIT_CRITICAL(&l_lock);
+
+    for (i = 0U; i < CONFIG_FREEACT_PROFILER_SLOTS; ++i)
+    {
+        ProfileEntry const* const p = &l_snap[i];
+
+        if (p->task == (TaskHandle_t)0)
+        {
+            continue;
+        }
+        if (p->act != (Active const*)0)
+        {
+            printf("%s;AO@%p;dispatch@%p;sig%u %lu\n", p->name, (void const*)p->act, (void*)p->fn,
+                   (unsigned)p->sig, (unsigned long)p->count);
+        }
+        else
+        {
+            printf("%s %lu\n", p->name, (unsigned long)p->count);
+        }
+    }
+    if (dropped != 0U)
+    {
+        printf("[dropped] %lu\n", (unsigned long)dropped);
+    }
+}
@@ -0,0 +1,250 @@
+/*****************************************************************************
+ * FreeAct I/O reactor
+ *
+ * MIT License, see FreeAct.h
+ *****************************************************************************/
+#include "FreeAct_reactor.h" /* Reactor interface */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/select.h>
+#include <sys/time.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/*..........................................................................*/
+void Reactor_ctor(Reactor* const me, ReactorWatch* watchSto, uint16_t nWatches, uint32_t pollMs)
+{
+    uint16_t i;
+
+    configASSERT((watchSto != (ReactorWatch*)0) && (nWatches > 0U));
+
+    me->thread   = (TaskHandle_t)0;
+    me->watches  = watchSto;
+    me->nWatches = nWatches;
+    me->pollMs   = (pollMs != 0U) ? pollMs : 1U;
+    portMUX_INITIALIZE(&me->lock);
+
+    for (i = 0U; i < nWatches; ++i)
+    {
+        watchSto[i].owner = (Active*)0;
+        watchSto[i].armed = false;
+        watchSto[i].selFd = -1;
+    }
+}
+
+/*..........................................................................*/
+/* Claim a watch slot for posting, under the lock: the slot must still be
+ * armed for the descriptor the reactor looked at ('fd'), since the owner
+ * may unwatch it and the slot may be reused meanwhile. Returns the owner to
+ * post to (after the lock is released), NULL if the slot changed.
+ */
+static Active* Reactor_claim(Reactor* const me, ReactorWatch* const w, int fd, uint8_t ready)
+{
+    Active* owner = (Active*)0;
+
+    portENTER_CRITICAL(&me->lock);
+    if (w->armed && (w->owner != (Active*)0) && (w->evt.fd == fd))
+    {
+        w->armed     = false; /* one-shot until Reactor_rearm() */
+        w->evt.ready = ready;
+        owner        = w->owner;
+    }
+    portEXIT_CRITICAL(&me->lock);
+
+    return owner;
+}
+
+/*..........................................................................*/
+/* select() failed: find the descriptors that went stale and report them */
+static void Reactor_reapStale(Reactor* const me)
+{
+    uint16_t i;
+
+    for (i = 0U; i < me->nWatches; ++i)
+    {
+        ReactorWatch* const w = &me->watches[i];
+        int                 fd;
+        Active*             owner;
+
+        portENTER_CRITICAL(&me->lock);
+        fd = w->armed ? w->evt.fd : -1;
+        portEXIT_CRITICAL(&me->lock);
+
+        if ((fd >= 0) && (fcntl(fd, F_GETFL) < 0))
+        {
+            owner = Reactor_claim(me, w, fd, REACTOR_ERROR);
+            if (owner != (Active*)0)
+            {
+                Active_post(owner, &w->evt.super);
+            }
+        }
+    }
+}
+
+/*..........................................................................*/
+/* thread function of the reactor (FreeRTOS task signature) */
+static void Reactor_eventLoop(void* pvParameters)
+{
+    Reactor* me = (Reactor*)pvParameters;
+
+    configASSERT(me); /* reactor must be provided */
+
+    for (;;)
+    { /* for-ever "superloop" */
+        fd_set         rd;
+        fd_set         wr;
+        int            maxfd = -1;
+        int            n;
+        struct timeval tv;
+        uint16_t       i;
+
+        FD_ZERO(&rd);
+        FD_ZERO(&wr);
+        portENTER_CRITICAL(&me->lock);
+        for (i = 0U; i < me->nWatches; ++i)
+        {
+            ReactorWatch* const w = &me->watches[i];
+
+            w->selFd = w->armed ? w->evt.fd : -1; /* what this select() watches */
+            if (w->armed)
+            {
+                if ((w->interest & REACTOR_READ) != 0U)
+                {
+                    FD_SET(w->evt.fd, &rd);
+                }
+                if ((w->interest & REACTOR_WRITE) != 0U)
+                {
+                    FD_SET(w->evt.fd, &wr);
+                }
+                if (w->evt.fd > maxfd)
+                {
+                    maxfd = w->evt.fd;
+                }
+            }
+        }
+        portEXIT_CRITICAL(&me->lock);
+
+        if (maxfd < 0)
+        {
+            vTaskDelay(pdMS_TO_TICKS(me->pollMs)); /* nothing to watch */
+            continue;
+        }
+
+        tv.tv_sec  = (time_t)(me->pollMs / 1000U);
+        tv.tv_usec = (suseconds_t)((me->pollMs % 1000U) * 1000U);
+        n          = select(maxfd + 1, &rd, &wr, (fd_set*)0, &tv); /* BLOCKING! */
+
+        if (n < 0)
+        {
+            if (errno == EBADF)
+            {
+                Reactor_reapStale(me);
+            }
+            else
+            {
+                vTaskDelay(pdMS_TO_TICKS(me->pollMs)); /* don't spin on errors */
+            }
+            continue;
+        }
+
+        /* only the descriptors in the sets, whatever happened to the slots */
+        for (i = 0U; (n > 0) && (i < me->nWatches); ++i)
+        {
+            ReactorWatch* const w     = &me->watches[i];
+            int const           fd    = w->selFd;
+            uint8_t             ready = 0U;
+            Active*             owner;
+
+            if (fd < 0)
+            {
+                continue;
+            }
+            if (FD_ISSET(fd, &rd))
+            {
+                ready |= REACTOR_READ;
+            }
+            if (FD_ISSET(fd, &wr))
+            {
+                ready |= REACTOR_WRITE;
+            }
+            if (ready != 0U)
+            {
+                --n;
+                owner = Reactor_claim(me, w, fd, ready);
+                if (owner != (Active*)0)
+                {
+                    Active_post(owner, &w->evt.super);
+                }
+            }
+        }
+    }
+}
+
+/*..........................................................................*/
+void Reactor_start(Reactor* const me, uint8_t prio, /* priority (1-based) */
+                   void* stackSto, uint32_t stackSize)
+{
+    StackType_t* stk_sto   = stackSto;
+    uint32_t     stk_depth = (stackSize / sizeof(StackType_t));
+
+    me->thread = xTaskCreateStatic(&Reactor_eventLoop,      /* the thread function */
+                                   "AOR",                   /* the name of the task */
+                                   stk_depth,               /* stack depth */
+                                   me,                      /* the 'pvParameters' parameter */
+                                   prio + tskIDLE_PRIORITY, /* FreeRTOS priority */
+                                   stk_sto,                 /* stack storage - provided by user */
+                                   &me->thread_cb);         /* task control block */
+    configASSERT(me->thread);                               /* thread must be created */
+}
+
+/*..........................................................................*/
+/* start watching a non-blocking descriptor on behalf of 'owner' */
+ReactorWatch* Reactor_watch(Reactor* const me, int fd, uint8_t interest, Active* owner, Signal sig)
+{
+    ReactorWatch* w = (ReactorWatch*)0;
+    uint16_t      i;
+
+    configASSERT((fd >= 0) && (fd < FD_SETSIZE));
+    configASSERT((interest & (REACTOR_READ | REACTOR_WRITE)) != 0U);
+
+    portENTER_CRITICAL(&me->lock);
+    for (i = 0U; i < me->nWatches; ++i)
+    {
+        if (me->watches[i].owner == (Active*)0)
+        {
+            w                = &me->watches[i];
+            w->evt.super.sig = sig;
+            w->evt.fd        = fd;
+            w->evt.ready     = 0U;
+            w->owner         = owner;
+            w->interest      = interest;
+            w->armed         = true;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&me->lock);
+
+    configASSERT(w != (ReactorWatch*)0); /* out of watch slots */
+    return w;
+}
+
+/*..........................................................................*/
+/* called by the owner once it has handled the IoEvent */
+void Reactor_rearm(Reactor* const me, ReactorWatch* const w)
+{
+    portENTER_CRITICAL(&me->lock);
+    w->armed = (w->owner != (Active*)0);
+    portEXIT_CRITICAL(&me->lock);
+}
+
+/*..........................................................................*/
+/* stop watching; close the descriptor only after this call */
+void Reactor_unwatch(Reactor* const me, ReactorWatch* const w)
+{
+    portENTER_CRITICAL(&me->lock);
+    w->armed = false;
+    w->owner = (Active*)0;
+    portEXIT_CRITICAL(&me->lock);
+}
@@ -0,0 +1,192 @@
+/*****************************************************************************
+ * FreeAct stream operators
+ *
+ * MIT License, see FreeAct.h
+ *****************************************************************************/
+#include "FreeAct_stream.h" /* Stream operators interface */
+
+#include <stddef.h>
+
+/*..........................................................................*/
+/* forward a value downstream, if anything is connected */
+static inline void Stream_emit(Stream* const me, int32_t value)
+{
+    if (me->next != (Stream*)0)
+    {
+        Stream_push(me->next, value);
+    }
+}
+
+/*..........................................................................*/
+static void Stream_init(Stream* const me, StreamPushFn push)
+{
+    me->push = push;
+    me->next = (Stream*)0;
+}
+
+/*..........................................................................*/
+void Stream_connect(Stream* const me, Stream* const next)
+{
+    me->next = next;
+}
+
+/*..........................................................................*/
+static void StreamMap_push(Stream* const me, int32_t value)
+{
+    Stream_emit(me, (*((StreamMap*)me)->fn)(value));
+}
+
+void StreamMap_ctor(StreamMap* const me, StreamMapFn fn)
+{
+    Stream_init(&me->super, &StreamMap_push);
+    me->fn = fn;
+}
+
+/*..........................................................................*/
+static void StreamFilter_push(Stream* const me, int32_t value)
+{
+    if ((*((StreamFilter*)me)->pred)(value))
+    {
+        Stream_emit(me, value);
+    }
+}
+
+void StreamFilter_ctor(StreamFilter* const me, StreamPredFn pred)
+{
+    Stream_init(&me->super, &StreamFilter_push);
+    me->pred = pred;
+}
+
+/*..........................................................................*/
+static void StreamScan_push(Stream* const me, int32_t value)
+{
+    StreamScan* const scan = (StreamScan*)me;
+
+    scan->acc = (*scan->fn)(scan->acc, value);
+    Stream_emit(me, scan->acc);
+}
+
+void StreamScan_ctor(StreamScan* const me, StreamReduceFn fn, int32_t seed)
+{
+    Stream_init(&me->super, &StreamScan_push);
+    me->fn  = fn;
+    me->acc = seed;
+}
+
+/*..........................................................................*/
+static void StreamMerge_push(Stream* const me, int32_t value)
+{
+    Stream_emit(me, value);
+}
+
+void StreamMerge_ctor(StreamMerge* const me)
+{
+    Stream_init(&me->super, &StreamMerge_push);
+}
+
+/*..........................................................................*/
+/* forward a pair once both sides have a value (the newest value of a side
+ * replaces an unpaired older one)
+ */
+static void StreamZip_pair(StreamZip* const me)
+{
+    if (me->lfull && me->rfull)
+    {
+        me->lfull = false;
+        me->rfull = false;
+        Stream_emit(&me->super, (*me->fn)(me->lval, me->rval));
+    }
+}
+
+static void StreamZip_pushLeft(Stream* const me, int32_t value)
+{
+    StreamZip* const zip = (StreamZip*)((uintptr_t)me - offsetof(StreamZip, left));
+
+    zip->lval  = value;
+    zip->lfull = true;
+    StreamZip_pair(zip);
+}
+
+static void StreamZip_pushRight(Stream* const me, int32_t value)
+{
+    StreamZip* const zip = (StreamZip*)((uintptr_t)me - offsetof(StreamZip, right));
+
+    zip->rval  = value;
+    zip->rfull = true;
+    StreamZip_pair(zip);
+}
+
+static void StreamZip_pushOutput(Stream* const me, int32_t value)
+{
+    (void)me;
+    (void)value;
+    configASSERT(0); /* connect upstream operators to 'left'/'right' */
+}
+
+void StreamZip_ctor(StreamZip* const me, StreamReduceFn fn)
+{
+    Stream_init(&me->super, &StreamZip_pushOutput);
+    Stream_init(&me->left, &StreamZip_pushLeft);
+    Stream_init(&me->right, &StreamZip_pushRight);
+    me->fn    = fn;
+    me->lval  = 0;
+    me->rval  = 0;
+    me->lfull = false;
+    me->rfull = false;
+}
+
+/*..........................................................................*/
+static void StreamWindow_push(Stream* const me, int32_t value)
+{
+    StreamWindow* const win = (StreamWindow*)me;
+
+    win->acc = (*win->fn)(win->acc, value);
+    if (++win->count >= win->size)
+    {
+        int32_t const result = win->acc;
+
+        win->acc   = win->seed;
+        win->count = 0U;
+        Stream_emit(me, result);
+    }
+}
+
+void StreamWindow_ctor(StreamWindow* const me, StreamReduceFn fn, int32_t seed, uint32_t size)
+{
+    configASSERT(size > 0U);
+
+    Stream_init(&me->super, &StreamWindow_push);
+    me->fn    = fn;
+    me->seed  = seed;
+    me->acc   = seed;
+    me->size  = size;
+    me->count = 0U;
+}
+
+/*..........................................................................*/
+static void StreamSink_push(Stream* const me, int32_t value)
+{
+    StreamSink* const sink = (StreamSink*)me;
+    SampleEvt* const  evt  = &sink->sto[sink->idx];
+
+    sink->idx  = (sink->idx + 1U < sink->len) ? (sink->idx + 1U) : 0U;
+    evt->value = value;
+    Active_post(sink->act, &evt->super);
+}
+
+void StreamSink_ctor(StreamSink* const me, Active* act, Signal sig, SampleEvt* sto, uint16_t len)
+{
+    uint16_t i;
+
+    configASSERT((sto != (SampleEvt*)0) && (len > 0U));
+
+    Stream_init(&me->super, &StreamSink_push);
+    me->act = act;
+    me->sto = sto;
+    me->len = len;
+    me->idx = 0U;
+    for (i = 0U; i < len; ++i)
+    {
+        sto[i].super.sig = sig;
+    }
+}
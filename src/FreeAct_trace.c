@@ -0,0 +1,120 @@
+/*****************************************************************************
+ * FreeAct event trace
+ *
+ * MIT License, see FreeAct.h
+ *****************************************************************************/
+#include "FreeAct_trace.h" /* trace interface */
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#define TAG "FreeAct"
+
+#define TRACE_CHUNK 16U /* records copied per lock hold */
+
+static TraceRec     l_ring[CONFIG_FREEACT_TRACE_LEN];
+static uint32_t     l_seq; /* sequence number of the next record */
+static portMUX_TYPE l_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/*..........................................................................*/
+int64_t FreeAct_time(void)
+{
+    return esp_timer_get_time();
+}
+
+/*..........................................................................*/
+void FreeAct_trace(uint8_t type, Active const* const act, Signal sig)
+{
+    TraceRec* r;
+
+    portENTER_CRITICAL_SAFE(&l_lock);
+    r       = &l_ring[l_seq % CONFIG_FREEACT_TRACE_LEN];
+    r->ts   = FreeAct_time(); /* under the lock: monotonic in 'seq' */
+    r->seq  = l_seq++;
+    r->act  = act;
+    r->sig  = sig;
+    r->type = type;
+    r->core = (uint8_t)xPortGetCoreID();
+    portEXIT_CRITICAL_SAFE(&l_lock);
+}
+
+/*..........................................................................*/
+/* Copies at most TRACE_CHUNK records per lock hold, so both cores keep
+ * running (and tracing) while a long ring is copied. Records overwritten
+ * in the meantime are skipped; they show as a gap in 'seq'.
+ */
+uint32_t FreeAct_traceSnapshot(TraceRec* buf, uint32_t maxLen)
+{
+    uint32_t next;
+    uint32_t end;
+    uint32_t n = 0U;
+
+    portENTER_CRITICAL(&l_lock);
+    end  = l_seq;
+    next = (end < CONFIG_FREEACT_TRACE_LEN) ? 0U : (end - CONFIG_FREEACT_TRACE_LEN);
+    portEXIT_CRITICAL(&l_lock);
+
+    if ((end - next) > maxLen)
+    {
+        next = end - maxLen; /* keep the newest */
+    }
+
+    while (next != end)
+    {
+        uint32_t k;
+
+        portENTER_CRITICAL(&l_lock);
+        if ((l_seq - next) > CONFIG_FREEACT_TRACE_LEN)
+        {
+            next = l_seq - CONFIG_FREEACT_TRACE_LEN; /* overwritten meanwhile */
+            if ((int32_t)(end - next) < 0)
+            {
+                next = end; /* everything up to 'end' is gone */
+            }
+        }
+        for (k = 0U; (k < TRACE_CHUNK) && (next != end); ++k)
+        {
+            buf[n++] = l_ring[next % CONFIG_FREEACT_TRACE_LEN];
+            ++next;
+        }
+        portEXIT_CRITICAL(&l_lock);
+    }
+
+    return n;
+}
+
+/*..........................................................................*/
+void FreeAct_traceDump(void)
+{
+    static char const* const names[] = {"post", "dispatch", "done"};
+    static TraceRec          buf[CONFIG_FREEACT_TRACE_LEN]; /* off the caller's stack */
+    static bool              busy;
+    bool                     mine;
+    uint32_t                 n;
+    uint32_t                 i;
+
+    /* 'buf' is shared: one dump at a time */
+    portENTER_CRITICAL(&l_lock);
+    mine = !busy;
+    busy = true;
+    portEXIT_CRITICAL(&l_lock);
+    if (!mine)
+    {
+        ESP_LOGW(TAG, "trace dump already running");
+        return;
+    }
+
+    n = FreeAct_traceSnapshot(buf, CONFIG_FREEACT_TRACE_LEN);
+    for (i = 0U; i < n; ++i)
+    {
+        ESP_LOGI(TAG, "trace #%lu %lld us core %u %-8s AO %p sig %u", (unsigned long)buf[i].seq, (long long)buf[i].ts,
+                 (unsigned)buf[i].core, names[buf[i].type], (void const*)buf[i].act, (unsigned)buf[i].sig);
+    }
+
+    portENTER_CRITICAL(&l_lock);
+    busy = false;
+    portEXIT_CRITICAL(&l_lock);
+}